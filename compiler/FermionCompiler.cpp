@@ -28,13 +28,14 @@
  *   Initial API and implementation - Alex McCaskey
  *
  **********************************************************************************/
-#include <regex>
-#include <boost/algorithm/string.hpp>
 #include "FermionCompiler.hpp"
+#include "FermionKernelParser.hpp"
 #include "RuntimeOptions.hpp"
 #include "ServiceRegistry.hpp"
 #include "FermionKernel.hpp"
 #include "MPIProvider.hpp"
+#include "TransformationCache.hpp"
+#include "ModeOrdering.hpp"
 
 namespace xacc {
 
@@ -57,50 +58,81 @@ std::shared_ptr<IR> FermionCompiler::compile(const std::string& src,
 	provider->initialize();
 	auto world = provider->getCommunicator();
 
-	// Here we expect we have a kernel, only one kernel
-
-	// First off, split the string into lines
-	std::vector<std::string> lines, fLineSpaces;
-	boost::split(lines, src, boost::is_any_of("\n"));
-	auto functionLine = lines[0];
-	boost::split(fLineSpaces, functionLine, boost::is_any_of(" "));
-	auto fName = fLineSpaces[1];
-	boost::trim(fName);
-	fName = fName.substr(0, fName.find_first_of("("));
-	auto firstCodeLine = lines.begin() + 1;
-	auto lastCodeLine = lines.end() - 1;
-	std::vector<std::string> fermionStrVec(firstCodeLine, lastCodeLine);
-
+	// Here we expect we have a kernel, only one kernel,
+	// whose terms are parsed straight into the FermionKernel
 	fermionKernel = std::make_shared<FermionKernel>("fName");
-	nQubits = 0;
-	for (auto termStr : fermionStrVec) {
-		boost::trim(termStr);
-		if (!termStr.empty() && (std::string::npos != termStr.find_first_of("0123456789"))) {
-			std::vector<std::string> splitOnSpaces;
-			boost::split(splitOnSpaces, termStr, boost::is_any_of(" "));
-
-			// We know first term is coefficient
-			// FIXME WHAT IF COMPLEX
-			auto coeff = std::stod(splitOnSpaces[0]);
-			std::vector<std::pair<int, int>> operators;
-			for (int i = 1; i < splitOnSpaces.size()-1; i+=2) {
-				auto siteIdx = std::stoi(splitOnSpaces[i]);
-				if (siteIdx > nQubits) {
-					nQubits = siteIdx;
+	FermionKernelParser parser(PauliOperator::getNumThreads());
+	int maxSite;
+	if (xacc::optionExists("fermion-kernel-file")) {
+		auto path = xacc::getOption("fermion-kernel-file");
+		if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent")) {
+			xacc::info("Parsing fermion kernel " + path);
+			auto reported = std::make_shared<int>(0);
+			parser.setProgressCallback([=](std::size_t done, std::size_t total) {
+				int percent = total ? 100 * done / total : 100;
+				if (percent >= *reported + 10) {
+					*reported = percent - percent % 10;
+					xacc::info("Parsed " + std::to_string(*reported) + "% of " + path);
 				}
-				operators.push_back(
-						{siteIdx, std::stoi(
-								splitOnSpaces[i + 1]) });
+			});
+		}
+		maxSite = parser.parseFile(path, fermionKernel->getOperator());
+	} else {
+		maxSite = parser.parse(src, fermionKernel->getOperator());
+	}
+
+	nQubits = std::max(maxSite, 0) + 1;
+	xacc::setOption("n-qubits", std::to_string(nQubits));
+	if (parser.getNElectrons() >= 0 && !xacc::optionExists("n-electrons")) {
+		xacc::setOption("n-electrons", std::to_string(parser.getNElectrons()));
+	}
+
+	// Place the modes on qubits so that Jordan-Wigner strings are
+	// short. Every rank derives the same permutation.
+	bool permuted = false;
+	if (xacc::optionExists("fermion-mode-ordering")) {
+		auto& op = fermionKernel->getOperator();
+		auto method = xacc::getOption("fermion-mode-ordering");
+		auto objective = xacc::optionExists("fermion-mode-ordering-objective")
+				&& xacc::getOption("fermion-mode-ordering-objective") == "max" ?
+						ModeOrdering::Objective::Max : ModeOrdering::Objective::Total;
+		ModeOrdering ordering(op, nQubits);
+		std::vector<int> permutation;
+		if (method == "rcm" || method == "rcm-local") {
+			permutation = ordering.optimize(objective, method == "rcm-local");
+		} else {
+			permutation = ModeOrdering::parse(method);
+			if (permutation.size() != nQubits) {
+				xacc::error("fermion-mode-ordering must place all "
+						+ std::to_string(nQubits) + " modes.");
 			}
+		}
 
-			auto fermionInst = std::make_shared<FermionInstruction>(operators,
-					coeff);
-			fermionKernel->addInstruction(fermionInst);
+		if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent")) {
+			std::vector<int> identity(nQubits);
+			for (int m = 0; m < nQubits; m++) {
+				identity[m] = m;
+			}
+			xacc::info("Mode ordering shortens Jordan-Wigner strings from "
+					+ std::to_string(ordering.totalLength(identity)) + " to "
+					+ std::to_string(ordering.totalLength(permutation))
+					+ " weighted qubits, longest "
+					+ std::to_string(ordering.maxLength(identity)) + " to "
+					+ std::to_string(ordering.maxLength(permutation)) + ".");
 		}
+
+		op.permuteSites(permutation);
+		fermionKernel->setModePermutation(permutation);
+		permuted = true;
 	}
 
-	nQubits++;
-	xacc::setOption("n-qubits", std::to_string(nQubits));
+	// Pack the integrals once, later queries share them. An
+	// FCIDUMP arrives packed already, in the original mode order.
+	if (parser.getIntegrals() && !permuted) {
+		fermionKernel->setIntegrals(parser.getIntegrals());
+	} else {
+		fermionKernel->buildIntegrals();
+	}
 
 	// Create the FermionIR to pass to our transformation.
 	auto fermionir = std::make_shared<FermionIR>();
@@ -120,12 +152,35 @@ std::shared_ptr<IR> FermionCompiler::compile(const std::string& src,
 			transform = xacc::getService<IRTransformation>("jw");
 		}
 
+		// Reuse a cached result of this transformation if we have one
+		auto cache = TransformationCache::fromOptions();
+		auto spinTransform = std::dynamic_pointer_cast<
+				FermionToSpinTransformation>(transform);
+		std::string cacheKey;
+		PauliOperator cached;
+		if (cache && spinTransform) {
+			cacheKey = TransformationCache::key(*fermionKernel,
+					spinTransform->cacheKey(nQubits), nQubits);
+		}
+
 		// Create the Spin Hamiltonian
-		if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent"))
-			xacc::info("Mapping Fermion to Spin with " + transform->name());
-		auto transformedIR = transform->transform(fermionir);
-		if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent"))
-			xacc::info("Done mapping Fermion to Spin.");
+		std::shared_ptr<IR> transformedIR;
+		if (!cacheKey.empty() && cache->lookup(cacheKey, cached)) {
+			if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent"))
+				xacc::info("Loaded " + transform->name() + " Spin Hamiltonian from "
+						+ cache->getDirectory() + ".");
+			spinTransform->setResult(cached, fermionKernel);
+			transformedIR = cached.toXACCIR();
+		} else {
+			if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent"))
+				xacc::info("Mapping Fermion to Spin with " + transform->name());
+			transformedIR = transform->transform(fermionir);
+			if (world->rank() == 0 && !xacc::optionExists("fermion-compiler-silent"))
+				xacc::info("Done mapping Fermion to Spin.");
+			if (!cacheKey.empty() && world->rank() == 0) {
+				cache->store(cacheKey, spinTransform->getResult());
+			}
+		}
 
 		// Prepend State Preparation if requested.
 		if (xacc::optionExists("state-preparation")) {
@@ -82,6 +82,31 @@ public:
 				"fermion-list-transformations",
 				"List all available fermion-to-spin transformations.")
 				("no-fermion-transformation", "Skip JW/BK transformation step.")
+				("linear-encoding", value<std::string>(), "The binary encoding used by "
+						"the linear-encoding transformation, jw, parity, bk, segment "
+						"or custom, default parity.")
+				("linear-encoding-segment-size", value<std::string>(), "The number "
+						"of modes per parity segment of the segment encoding, default 2.")
+				("linear-encoding-matrix", value<std::string>(), "The rows of the "
+						"custom encoding matrix, strings of 0 and 1 separated by commas.")
+				("fermion-mode-ordering", value<std::string>(), "Place the fermionic "
+						"modes on qubits to shorten Jordan-Wigner strings, with rcm for "
+						"reverse Cuthill-McKee on the integral graph, rcm-local to refine "
+						"it by local search, or an explicit comma-separated permutation "
+						"giving the qubit of each mode. The permutation used is kept "
+						"on the compiled FermionKernel, and qubit-map then maps the "
+						"reordered qubits.")
+				("fermion-mode-ordering-objective", value<std::string>(), "Minimize the "
+						"total string length weighted by integral magnitude, total, or "
+						"the longest string, max. Default is total.")
+				("fermion-kernel-file", value<std::string>(), "Parse the fermion "
+						"Hamiltonian terms, or FCIDUMP integrals, from this file, memory "
+						"mapped and in parallel, instead of from the kernel source.")
+				("fermion-cache-dir", value<std::string>(), "Cache fermion-to-spin "
+						"transformation results in the given directory and reuse them "
+						"when the same Hamiltonian is transformed again.")
+				("fermion-cache-size", value<std::string>(), "The maximum size in MB "
+						"of the transformation cache, default 1024.")
 				("fermion-compiler-silent","Turn off print statements.");
 		return desc;
 	}
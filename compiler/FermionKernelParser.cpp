@@ -0,0 +1,613 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include "FermionKernelParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace xacc {
+
+namespace vqe {
+
+namespace {
+
+/**
+ * Chunks smaller than this are not worth a thread.
+ */
+const std::size_t MinChunkBytes = 1 << 20;
+
+/**
+ * Bytes parsed between progress updates.
+ */
+const std::size_t ProgressBytes = 1 << 22;
+
+bool isBlank(const char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool isDigit(const char c) {
+	return c >= '0' && c <= '9';
+}
+
+void skipBlanks(const char*& p, const char* end) {
+	while (p < end && isBlank(*p)) {
+		p++;
+	}
+}
+
+const char* endOfLine(const char* p, const char* end) {
+	auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+	return eol ? eol : end;
+}
+
+/**
+ * Lines without a digit, like braces or blank
+ * lines, carry no term.
+ */
+bool hasTerm(const char* p, const char* eol) {
+	for (; p < eol; p++) {
+		if (isDigit(*p)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * A C locale for the rare numbers that need strtod.
+ */
+locale_t cLocale() {
+	static locale_t loc = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+	return loc;
+}
+
+std::string lineError(const char* what, const char* line, const char* eol) {
+	return std::string(what) + ": '"
+			+ std::string(line, std::min<std::size_t>(eol - line, 80)) + "'";
+}
+
+}
+
+FermionKernelParser::FermionKernelParser(const int threads) :
+		nThreads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+}
+
+bool FermionKernelParser::parseDouble(const char*& p, const char* end,
+		double& value) {
+	static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+			1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+			1e20, 1e21, 1e22 };
+
+	auto start = p;
+	auto q = p;
+	bool negative = false;
+	if (q < end && (*q == '-' || *q == '+')) {
+		negative = *q == '-';
+		q++;
+	}
+
+	// Keep up to 19 significant digits, beyond that
+	// only the decimal exponent is tracked
+	std::uint64_t mantissa = 0;
+	int nDigits = 0, exponent = 0;
+	bool anyDigits = false, exact = true;
+	while (q < end && isDigit(*q)) {
+		if (nDigits < 19) {
+			mantissa = 10 * mantissa + (*q - '0');
+			nDigits += mantissa != 0;
+		} else {
+			exact = exact && *q == '0';
+			exponent++;
+		}
+		anyDigits = true;
+		q++;
+	}
+	if (q < end && *q == '.') {
+		q++;
+		while (q < end && isDigit(*q)) {
+			if (nDigits < 19) {
+				mantissa = 10 * mantissa + (*q - '0');
+				nDigits += mantissa != 0;
+				exponent--;
+			} else {
+				exact = exact && *q == '0';
+			}
+			anyDigits = true;
+			q++;
+		}
+	}
+	if (!anyDigits) {
+		return false;
+	}
+
+	if (q < end && (*q == 'e' || *q == 'E' || *q == 'd' || *q == 'D')) {
+		auto e = q + 1;
+		bool negativeExp = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExp = *e == '-';
+			e++;
+		}
+		if (e < end && isDigit(*e)) {
+			int exp = 0;
+			while (e < end && isDigit(*e)) {
+				exp = std::min(10 * exp + (*e - '0'), 100000);
+				e++;
+			}
+			exponent += negativeExp ? -exp : exp;
+			q = e;
+		}
+	}
+	p = q;
+
+	// Both factors are exact doubles, so one multiply
+	// or divide rounds correctly
+	if (mantissa == 0) {
+		value = negative ? -0.0 : 0.0;
+		return true;
+	}
+	if (exact && mantissa <= (std::uint64_t(1) << 53) && exponent >= -22
+			&& exponent <= 22) {
+		value = exponent < 0 ? double(mantissa) / pow10[-exponent] :
+				double(mantissa) * pow10[exponent];
+		value = negative ? -value : value;
+		return true;
+	}
+
+	// Otherwise defer to strtod, pinned to the C locale
+	std::string token(start, q);
+	for (auto& c : token) {
+		if (c == 'd' || c == 'D') {
+			c = 'e';
+		}
+	}
+	value = strtod_l(token.c_str(), nullptr, cLocale());
+	return true;
+}
+
+bool FermionKernelParser::parseInt(const char*& p, const char* end,
+		long& value) {
+	auto q = p;
+	bool negative = false;
+	if (q < end && (*q == '-' || *q == '+')) {
+		negative = *q == '-';
+		q++;
+	}
+	if (q == end || !isDigit(*q)) {
+		return false;
+	}
+	long v = 0;
+	for (int n = 0; q < end && isDigit(*q); n++, q++) {
+		if (n == 18) {
+			return false;
+		}
+		v = 10 * v + (*q - '0');
+	}
+	value = negative ? -v : v;
+	p = q;
+	return true;
+}
+
+void FermionKernelParser::countChunk(Chunk& chunk) {
+	auto p = chunk.begin;
+	while (p < chunk.end) {
+		auto eol = endOfLine(p, chunk.end);
+		if (hasTerm(p, eol)) {
+			// A coefficient then (site, creation) pairs, an
+			// unpaired trailing token is ignored
+			std::size_t nTokens = 0;
+			for (auto q = p; q < eol;) {
+				skipBlanks(q, eol);
+				if (q == eol) {
+					break;
+				}
+				nTokens++;
+				while (q < eol && !isBlank(*q)) {
+					q++;
+				}
+			}
+			auto nOps = (nTokens - 1) / 2;
+			if (nOps > FermionOperator::MaxOperators) {
+				chunk.error = lineError("Too many ladder operators", p, eol);
+				return;
+			}
+			chunk.nTerms++;
+			chunk.nSites += nOps;
+		}
+		p = eol + 1;
+	}
+}
+
+void FermionKernelParser::parseChunk(Chunk& chunk, FermionOperator& op,
+		std::atomic<std::size_t>& parsed) {
+	auto term = chunk.firstTerm;
+	auto site = chunk.firstSite;
+	auto p = chunk.begin;
+	auto reported = p;
+	while (p < chunk.end) {
+		auto line = p;
+		auto eol = endOfLine(p, chunk.end);
+		if (hasTerm(p, eol)) {
+			skipBlanks(p, eol);
+			double coeff;
+			if (!parseDouble(p, eol, coeff) || (p < eol && !isBlank(*p))) {
+				chunk.error = lineError("Invalid coefficient", line, eol);
+				return;
+			}
+
+			std::uint32_t mask = 0;
+			int k = 0;
+			while (true) {
+				skipBlanks(p, eol);
+				if (p == eol) {
+					break;
+				}
+				long s, creation;
+				if (!parseInt(p, eol, s) || (p < eol && !isBlank(*p))) {
+					chunk.error = lineError("Invalid site", line, eol);
+					return;
+				}
+				skipBlanks(p, eol);
+				if (p == eol) {
+					break;
+				}
+				if (!parseInt(p, eol, creation) || (p < eol && !isBlank(*p))) {
+					chunk.error = lineError("Invalid creation flag", line, eol);
+					return;
+				}
+				if (s < 0 || s > std::numeric_limits<std::int32_t>::max()) {
+					chunk.error = lineError("Site out of range", line, eol);
+					return;
+				}
+				op.siteArray[site++] = s;
+				mask |= std::uint32_t(creation ? 1 : 0) << k++;
+				chunk.maxSite = std::max<int>(chunk.maxSite, s);
+			}
+
+			op.offsets[term + 1] = site;
+			op.creationMasks[term] = mask;
+			op.coeffArray[term] = coeff;
+			op.varIdArray[term] = -1;
+			term++;
+		}
+		p = eol + 1;
+
+		auto done = std::min(p, chunk.end);
+		if (done - reported >= ProgressBytes) {
+			parsed += done - reported;
+			reported = done;
+		}
+	}
+	parsed += chunk.end - reported;
+}
+
+void FermionKernelParser::forEachChunk(std::vector<Chunk>& chunks,
+		std::function<void(Chunk&)> f, std::atomic<std::size_t>* parsed,
+		std::size_t total) const {
+	std::mutex m;
+	std::condition_variable finished;
+	std::size_t nFinished = 0;
+
+	std::vector<std::thread> threads;
+	for (auto& chunk : chunks) {
+		auto c = &chunk;
+		threads.emplace_back([&, c]() {
+			f(*c);
+			std::lock_guard<std::mutex> lock(m);
+			nFinished++;
+			finished.notify_one();
+		});
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m);
+		while (nFinished < chunks.size()) {
+			finished.wait_for(lock, std::chrono::milliseconds(200));
+			if (parsed && progress) {
+				progress(*parsed, total);
+			}
+		}
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
+std::vector<FermionKernelParser::Chunk> FermionKernelParser::makeChunks(
+		const char* begin, const char* end) const {
+	std::size_t total = end - begin;
+	auto nChunks = std::max<std::size_t>(1,
+			std::min<std::size_t>(nThreads, total / MinChunkBytes));
+	std::vector<Chunk> chunks(nChunks);
+	auto p = begin;
+	for (std::size_t k = 0; k < nChunks; k++) {
+		chunks[k].begin = p;
+		if (k + 1 < nChunks) {
+			p = std::max(p, begin + total * (k + 1) / nChunks);
+			p = endOfLine(p, end);
+			p = p < end ? p + 1 : end;
+		} else {
+			p = end;
+		}
+		chunks[k].end = p;
+	}
+	return chunks;
+}
+
+void FermionKernelParser::parseIntegrals(Chunk& chunk, const long nOrbitals,
+		std::atomic<std::size_t>& parsed) {
+	auto p = chunk.begin;
+	auto reported = p;
+	while (p < chunk.end) {
+		auto line = p;
+		auto eol = endOfLine(p, chunk.end);
+		skipBlanks(p, eol);
+		if (p < eol) {
+			// value i j k l, 1-based, with zeros marking
+			// one-electron integrals and the nuclear energy
+			double value;
+			long idx[4];
+			bool ok = parseDouble(p, eol, value);
+			for (int k = 0; ok && k < 4; k++) {
+				ok = p < eol && isBlank(*p);
+				skipBlanks(p, eol);
+				ok = ok && parseInt(p, eol, idx[k]) && idx[k] >= 0
+						&& idx[k] <= nOrbitals;
+			}
+			skipBlanks(p, eol);
+			if (!ok || p != eol) {
+				chunk.error = lineError("Invalid FCIDUMP record", line, eol);
+				return;
+			}
+
+			if (idx[0] && idx[1] && idx[2] && idx[3]) {
+				chunk.twoBody.push_back( { 0, std::uint16_t(idx[0] - 1),
+						std::uint16_t(idx[1] - 1), std::uint16_t(idx[2] - 1),
+						std::uint16_t(idx[3] - 1), value });
+			} else if (idx[0] && idx[1] && !idx[2] && !idx[3]) {
+				chunk.oneBody.push_back( { std::uint32_t(idx[0] - 1),
+						std::uint32_t(idx[1] - 1), value });
+			} else if (!idx[0] && !idx[1] && !idx[2] && !idx[3]) {
+				chunk.hasNuclearEnergy = true;
+				chunk.nuclearEnergy = value;
+			}
+			// Orbital energies, i 0 0 0, are not needed
+		}
+		p = eol + 1;
+
+		auto done = std::min(p, chunk.end);
+		if (done - reported >= ProgressBytes) {
+			parsed += done - reported;
+			reported = done;
+		}
+	}
+	parsed += chunk.end - reported;
+}
+
+int FermionKernelParser::parseFCIDump(const char* begin, const char* end,
+		FermionOperator& op) {
+
+	// The &FCI namelist ends at &END, $END or /
+	std::string header;
+	auto p = begin;
+	while (p < end) {
+		auto eol = endOfLine(p, end);
+		std::string line(p, eol);
+		p = eol < end ? eol + 1 : end;
+		std::transform(line.begin(), line.end(), line.begin(), ::toupper);
+		header += line + " ";
+		auto last = line.find_last_not_of(" \t\r");
+		if (line.find("&END") != std::string::npos
+				|| line.find("$END") != std::string::npos
+				|| (last != std::string::npos && line[last] == '/')) {
+			break;
+		}
+	}
+
+	auto headerValue = [&](const std::string& key) -> long {
+		auto at = header.find(key);
+		while (at != std::string::npos && at > 0 && std::isalpha(header[at - 1])) {
+			at = header.find(key, at + 1);
+		}
+		if (at == std::string::npos) {
+			return -1;
+		}
+		auto q = header.data() + at + key.size();
+		auto e = header.data() + header.size();
+		while (q < e && (isBlank(*q) || *q == '=')) {
+			q++;
+		}
+		long value;
+		return parseInt(q, e, value) ? value : -1;
+	};
+	auto nOrbitals = headerValue("NORB");
+	if (nOrbitals <= 0 || nOrbitals > 0x8000) {
+		xacc::error("FCIDUMP header has no valid NORB.");
+	}
+	nElectrons = headerValue("NELEC");
+
+	std::size_t total = end - p;
+	auto chunks = makeChunks(p, end);
+	std::atomic<std::size_t> parsed(0);
+	forEachChunk(chunks, [&](Chunk& c) {
+		parseIntegrals(c, nOrbitals, parsed);
+	}, &parsed, total);
+	if (progress) {
+		progress(total, total);
+	}
+
+	// Gather the records in file order, so a repeated
+	// integral keeps its last value
+	std::vector<IntegralStore::OneBodyIntegral> oneBody;
+	std::vector<IntegralStore::TwoBodyIntegral> twoBody;
+	double eNuc = 0.0;
+	for (auto& chunk : chunks) {
+		if (!chunk.error.empty()) {
+			xacc::error(chunk.error);
+		}
+		oneBody.insert(oneBody.end(), chunk.oneBody.begin(), chunk.oneBody.end());
+		twoBody.insert(twoBody.end(), chunk.twoBody.begin(), chunk.twoBody.end());
+		std::vector<IntegralStore::OneBodyIntegral>().swap(chunk.oneBody);
+		std::vector<IntegralStore::TwoBodyIntegral>().swap(chunk.twoBody);
+		if (chunk.hasNuclearEnergy) {
+			eNuc = chunk.nuclearEnergy;
+		}
+	}
+
+	integrals = std::make_shared<const IntegralStore>(nOrbitals, eNuc,
+			oneBody, twoBody);
+	integrals->expand(op);
+	return 2 * nOrbitals - 1;
+}
+
+int FermionKernelParser::parse(const char* begin, const char* end,
+		FermionOperator& op) {
+	integrals.reset();
+	nElectrons = -1;
+
+	auto first = begin;
+	while (first < end && (isBlank(*first) || *first == '\n')) {
+		first++;
+	}
+	if (end - first >= 4 && first[0] == '&' && std::toupper(first[1]) == 'F'
+			&& std::toupper(first[2]) == 'C' && std::toupper(first[3]) == 'I') {
+		return parseFCIDump(first, end, op);
+	}
+
+	// Parse only the body of a __qpu__ kernel
+	static const char qpu[] = "__qpu__";
+	auto kernel = std::search(begin, end, qpu, qpu + sizeof(qpu) - 1);
+	if (kernel != end) {
+		auto open = std::find(kernel, end, '{');
+		auto close = end;
+		while (close > open && *(close - 1) != '}') {
+			close--;
+		}
+		if (open == end || close <= open + 1) {
+			xacc::error("Fermion kernel has no body between braces.");
+		}
+		begin = open + 1;
+		end = close - 1;
+	}
+
+	std::size_t total = end - begin;
+	auto chunks = makeChunks(begin, end);
+
+	// Size the operator once, then every chunk writes
+	// its terms straight into its own slots
+	forEachChunk(chunks, countChunk, nullptr, total);
+	auto nTerms = op.nTerms(), nSites = op.siteArray.size();
+	for (auto& chunk : chunks) {
+		if (!chunk.error.empty()) {
+			xacc::error(chunk.error);
+		}
+		chunk.firstTerm = nTerms;
+		chunk.firstSite = nSites;
+		nTerms += chunk.nTerms;
+		nSites += chunk.nSites;
+	}
+	if (nSites > std::numeric_limits<std::uint32_t>::max()) {
+		xacc::error("Fermion kernel has too many ladder operators.");
+	}
+	op.offsets.resize(nTerms + 1);
+	op.siteArray.resize(nSites);
+	op.creationMasks.resize(nTerms);
+	op.coeffArray.resize(nTerms);
+	op.varIdArray.resize(nTerms);
+
+	std::atomic<std::size_t> parsed(0);
+	forEachChunk(chunks, [&](Chunk& c) {
+		parseChunk(c, op, parsed);
+	}, &parsed, total);
+	if (progress) {
+		progress(total, total);
+	}
+
+	int maxSite = -1;
+	for (auto& chunk : chunks) {
+		if (!chunk.error.empty()) {
+			xacc::error(chunk.error);
+		}
+		maxSite = std::max(maxSite, chunk.maxSite);
+	}
+	return maxSite;
+}
+
+int FermionKernelParser::parseFile(const std::string& path,
+		FermionOperator& op) {
+	auto fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		xacc::error("Could not open fermion kernel file " + path + ".");
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		xacc::error("Could not read fermion kernel file " + path + ".");
+	}
+	std::size_t length = st.st_size;
+	if (length == 0) {
+		close(fd);
+		integrals.reset();
+		nElectrons = -1;
+		return -1;
+	}
+
+	auto addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		xacc::error("Could not memory-map " + path + ".");
+	}
+	madvise(addr, length, MADV_SEQUENTIAL);
+	std::shared_ptr<const char> mapping(static_cast<const char*>(addr),
+			[length](const char* p) {
+				munmap(const_cast<char*>(p), length);
+			});
+
+	return parse(mapping.get(), mapping.get() + length, op);
+}
+
+}
+
+}
@@ -0,0 +1,221 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_COMPILER_FERMIONKERNELPARSER_HPP_
+#define VQE_COMPILER_FERMIONKERNELPARSER_HPP_
+
+#include "IntegralStore.hpp"
+#include <atomic>
+#include <functional>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The FermionKernelParser reads the terms of a fermion
+ * kernel, one "coeff site creation site creation ..." term
+ * per line, straight into a FermionOperator. Files are memory
+ * mapped rather than read, the text is cut into chunks at line
+ * boundaries that are parsed concurrently, and numbers are read
+ * without going through the C or C++ locale. Chunks are appended
+ * in order, so the terms keep the order of the source.
+ *
+ * FCIDUMP text, spatial-orbital integrals after an &FCI namelist,
+ * is recognized as well. Its records are packed into an
+ * IntegralStore, which expands them into spin-orbital terms.
+ */
+class FermionKernelParser {
+
+public:
+
+	/**
+	 * Called with the number of bytes parsed so far
+	 * and the total number of bytes.
+	 */
+	using ProgressCallback = std::function<void(std::size_t, std::size_t)>;
+
+protected:
+
+	int nThreads;
+
+	ProgressCallback progress;
+
+	/**
+	 * The integrals of the last FCIDUMP parsed.
+	 */
+	std::shared_ptr<const IntegralStore> integrals;
+
+	int nElectrons = -1;
+
+	/**
+	 * The extent of one chunk of lines, where its terms and
+	 * sites go in the operator, or the FCIDUMP integrals in it.
+	 */
+	struct Chunk {
+		const char* begin;
+		const char* end;
+		std::size_t nTerms = 0;
+		std::size_t nSites = 0;
+		std::size_t firstTerm = 0;
+		std::size_t firstSite = 0;
+		int maxSite = -1;
+		std::vector<IntegralStore::OneBodyIntegral> oneBody;
+		std::vector<IntegralStore::TwoBodyIntegral> twoBody;
+		bool hasNuclearEnergy = false;
+		double nuclearEnergy = 0.0;
+		std::string error;
+	};
+
+	/**
+	 * Cut [begin, end) into one chunk per thread at line ends.
+	 */
+	std::vector<Chunk> makeChunks(const char* begin, const char* end) const;
+
+	/**
+	 * Count the terms and sites of a chunk.
+	 */
+	static void countChunk(Chunk& chunk);
+
+	/**
+	 * Parse the terms of a chunk into their slots of op,
+	 * adding the bytes done to parsed as it goes.
+	 */
+	static void parseChunk(Chunk& chunk, FermionOperator& op,
+			std::atomic<std::size_t>& parsed);
+
+	/**
+	 * Parse the FCIDUMP records of a chunk, whose
+	 * indices must not exceed nOrbitals.
+	 */
+	static void parseIntegrals(Chunk& chunk, const long nOrbitals,
+			std::atomic<std::size_t>& parsed);
+
+	/**
+	 * Parse FCIDUMP text into integrals and expand it into op.
+	 */
+	int parseFCIDump(const char* begin, const char* end, FermionOperator& op);
+
+	/**
+	 * Run f on every chunk, one thread each, reporting
+	 * progress from the calling thread until all finish.
+	 */
+	void forEachChunk(std::vector<Chunk>& chunks,
+			std::function<void(Chunk&)> f, std::atomic<std::size_t>* parsed,
+			std::size_t total) const;
+
+public:
+
+	/**
+	 * The constructor, takes the number of threads to
+	 * parse with, all hardware threads if 0.
+	 */
+	FermionKernelParser(const int threads = 0);
+
+	/**
+	 * Report progress through f, every few MB of text
+	 * and once at the end.
+	 */
+	void setProgressCallback(ProgressCallback f) {
+		progress = f;
+	}
+
+	/**
+	 * Parse the kernel text in [begin, end) and append its
+	 * terms to op. The text is either a whole __qpu__ kernel,
+	 * whose body between the braces is parsed, or bare term
+	 * lines. Lines without any digit are skipped. FCIDUMP text
+	 * is expanded to spin orbitals 2i (alpha) and 2i + 1 (beta).
+	 *
+	 * @param begin The start of the text
+	 * @param end One past the end of the text
+	 * @param op The operator to append to
+	 * @return maxSite The largest site, -1 if there is none
+	 */
+	int parse(const char* begin, const char* end, FermionOperator& op);
+
+	int parse(const std::string& src, FermionOperator& op) {
+		return parse(src.data(), src.data() + src.size(), op);
+	}
+
+	/**
+	 * Memory map the given file and parse it as above.
+	 *
+	 * @param path The kernel file
+	 * @param op The operator to append to
+	 * @return maxSite The largest site, -1 if there is none
+	 */
+	int parseFile(const std::string& path, FermionOperator& op);
+
+	/**
+	 * Return the packed integrals if the last text parsed was
+	 * an FCIDUMP, null otherwise.
+	 */
+	std::shared_ptr<const IntegralStore> getIntegrals() const {
+		return integrals;
+	}
+
+	/**
+	 * Return the NELEC of the last FCIDUMP parsed, -1 if
+	 * there was none.
+	 */
+	int getNElectrons() const {
+		return nElectrons;
+	}
+
+	/**
+	 * Read a decimal floating point number at p, advancing
+	 * p past it. Fortran exponents (1.0D-3) are accepted. The
+	 * result is correctly rounded and does not depend on the
+	 * current locale.
+	 *
+	 * @param p The read position
+	 * @param end The end of the text
+	 * @param value The number read
+	 * @return ok False if there is no number at p
+	 */
+	static bool parseDouble(const char*& p, const char* end, double& value);
+
+	/**
+	 * Read a signed decimal integer at p, advancing p past it.
+	 *
+	 * @param p The read position
+	 * @param end The end of the text
+	 * @param value The number read
+	 * @return ok False if there is no number at p
+	 */
+	static bool parseInt(const char*& p, const char* end, long& value);
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,242 @@
+/***********************************************************************************
+ * Copyright (c) 2016, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include <gtest/gtest.h>
+#include "FermionKernelParser.hpp"
+#include "tests/ExpectXACCError.hpp"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace xacc::vqe;
+
+TEST(FermionKernelParserTester,checkParseDouble) {
+	std::vector<std::string> numbers { "0", "-0.0", "3.17", "-0.962973543364",
+			"+12", ".5", "5.", "1e-3", "1.0D-03", "-2.5E+10", "0.1234567890123456",
+			"0.12345678901234567", "123456789012345678901234", "1e-320",
+			"4.9406564584124654e-324", "1.7976931348623157e308", "0.3",
+			"2.2250738585072014e-308", "9007199254740993", "0.000000000000000000001" };
+	for (auto& n : numbers) {
+		auto p = n.data();
+		double v;
+		EXPECT_TRUE(FermionKernelParser::parseDouble(p, n.data() + n.size(), v));
+		EXPECT_EQ(n.data() + n.size(), p);
+
+		std::istringstream ss(n[n.size() - 4] == 'D' ? "1.0e-03" : n);
+		ss.imbue(std::locale::classic());
+		double expected;
+		ss >> expected;
+		EXPECT_EQ(expected, v) << n;
+	}
+
+	// Random round trips must be bit identical
+	std::mt19937 gen(3);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	std::uniform_int_distribution<int> exps(-30, 30);
+	for (int i = 0; i < 10000; i++) {
+		std::stringstream ss;
+		ss.imbue(std::locale::classic());
+		ss.precision(17 - i % 10);
+		auto x = dist(gen) * std::pow(10.0, exps(gen));
+		ss << x;
+		auto s = ss.str();
+		auto p = s.data();
+		double v, expected;
+		FermionKernelParser::parseDouble(p, s.data() + s.size(), v);
+		ss.seekg(0);
+		ss >> expected;
+		EXPECT_EQ(expected, v) << s;
+	}
+
+	std::string bad = "-x";
+	auto p = bad.data();
+	double v;
+	EXPECT_FALSE(FermionKernelParser::parseDouble(p, bad.data() + 2, v));
+	EXPECT_EQ(bad.data(), p);
+}
+
+TEST(FermionKernelParserTester,checkParse) {
+	const std::string code = "__qpu__ H2() {\n"
+			"\t0.286177854957 1 1 0 1 0 0 1 0\n"
+			"\t-0.962973543364 1 1 1 0\n"
+			"\n"
+			"\t0.394095527599\n"
+			"  -0.653040869332   3 1\t3 0 \r\n"
+			"}";
+
+	FermionOperator op;
+	FermionKernelParser parser(2);
+	EXPECT_EQ(3, parser.parse(code, op));
+	EXPECT_EQ(4, op.nTerms());
+	EXPECT_EQ(4, op.nOperators(0));
+	EXPECT_EQ((std::vector<std::pair<int, int>> { { 1, 1 }, { 0, 1 }, { 0, 0 }, { 1, 0 } }),
+			op.operators(0));
+	EXPECT_EQ(std::complex<double>(0.286177854957, 0), op.coeff(0));
+	EXPECT_EQ(2, op.nOperators(1));
+	EXPECT_EQ(0, op.nOperators(2));
+	EXPECT_EQ(std::complex<double>(0.394095527599, 0), op.coeff(2));
+	EXPECT_EQ((std::vector<std::pair<int, int>> { { 3, 1 }, { 3, 0 } }),
+			op.operators(3));
+	EXPECT_EQ(-1, op.varId(3));
+
+	// Bare term lines append to what is there
+	EXPECT_EQ(5, parser.parse("1.5 5 1 2 0", op));
+	EXPECT_EQ(5, op.nTerms());
+	EXPECT_EQ(5, op.site(4, 0));
+
+	EXPECT_XACC_ERROR(parser.parse("1.5 5 x 2 0", op));
+	EXPECT_XACC_ERROR(parser.parse("theta 5 1 2 0", op));
+}
+
+TEST(FermionKernelParserTester,checkParallelParseFile) {
+
+	// A few MB of terms, enough to split over threads
+	std::mt19937 gen(5);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	std::uniform_int_distribution<int> sites(0, 99);
+	std::stringstream ss;
+	ss.imbue(std::locale::classic());
+	ss.precision(16);
+	ss << "__qpu__ big() {\n";
+	for (int i = 0; i < 200000; i++) {
+		ss << "\t" << dist(gen) << " " << sites(gen) << " 1 " << sites(gen)
+				<< " 1 " << sites(gen) << " 0 " << sites(gen) << " 0\n";
+	}
+	ss << "}";
+	auto src = ss.str();
+
+	auto path = "fermion_kernel_parser_test.hpp";
+	{
+		std::ofstream out(path);
+		out << src;
+	}
+
+	FermionOperator serial, parallel;
+	FermionKernelParser(1).parse(src, serial);
+	std::size_t lastDone = 0, lastTotal = 0;
+	FermionKernelParser parser(4);
+	parser.setProgressCallback([&](std::size_t done, std::size_t total) {
+		EXPECT_GE(done, lastDone);
+		lastDone = done;
+		lastTotal = total;
+	});
+	EXPECT_EQ(99, parser.parseFile(path, parallel));
+	std::remove(path);
+
+	EXPECT_EQ(lastTotal, lastDone);
+	EXPECT_GT(lastTotal, 0);
+	EXPECT_EQ(200000, serial.nTerms());
+	EXPECT_EQ(serial.nTerms(), parallel.nTerms());
+	for (std::size_t i = 0; i < serial.nTerms(); i++) {
+		EXPECT_EQ(serial.operators(i), parallel.operators(i));
+		EXPECT_EQ(serial.coeff(i), parallel.coeff(i));
+	}
+}
+
+TEST(FermionKernelParserTester,checkFCIDump) {
+	// H2 in a minimal basis, unique integrals only
+	const std::string fcidump = " &FCI NORB=  2,NELEC=  2,MS2= 0,\n"
+			"  ORBSYM=1,5,\n"
+			"  ISYM=1,\n"
+			" &END\n"
+			"  0.6744887663568382D+00   1   1   1   1\n"
+			"  0.1812104620151246D+00   2   1   2   1\n"
+			"  0.6634680388959121D+00   2   2   1   1\n"
+			"  0.6973949389120475D+00   2   2   2   2\n"
+			" -0.1252463573564899D+01   1   1   0   0\n"
+			" -0.4759487152209626D+00   2   2   0   0\n"
+			" -0.5782052886220838D+00   1   0   0   0\n"
+			"  0.7137539936876182D+00   0   0   0   0\n";
+
+	FermionOperator op;
+	FermionKernelParser parser(2);
+	EXPECT_EQ(3, parser.parse(fcidump, op));
+	EXPECT_EQ(2, parser.getNElectrons());
+	auto store = parser.getIntegrals();
+	EXPECT_TRUE(bool(store));
+	EXPECT_EQ(2, store->nSpatialOrbitals());
+	EXPECT_EQ(2, store->getOneBodyIntegrals().size());
+	EXPECT_EQ(4, store->getTwoBodyIntegrals().size());
+	EXPECT_EQ(0.1812104620151246, store->twoBodyIntegral(0, 1, 1, 0));
+
+	// The constant, 4 one-body and 24 two-body terms that
+	// survive the spin and permutational symmetries
+	EXPECT_EQ(29, op.nTerms());
+	EXPECT_EQ(0, op.nOperators(0));
+	EXPECT_EQ(std::complex<double>(0.7137539936876182, 0), op.coeff(0));
+	EXPECT_EQ((std::vector<std::pair<int, int>> { { 1, 1 }, { 1, 0 } }),
+			op.operators(2));
+	EXPECT_EQ(std::complex<double>(-1.252463573564899, 0), op.coeff(2));
+	for (std::size_t i = 0; i < op.nTerms(); i++) {
+		if (op.nOperators(i) == 4) {
+			EXPECT_NE(op.site(i, 0), op.site(i, 1));
+			EXPECT_NE(op.site(i, 2), op.site(i, 3));
+		}
+	}
+
+	// Packing the expanded terms again gives back the same
+	// integrals, and every spin-orbital coefficient agrees
+	IntegralStore repacked(op);
+	EXPECT_EQ(store->getTwoBodyIntegrals().size(),
+			repacked.getTwoBodyIntegrals().size());
+	for (int p = 0; p < 4; p++) {
+		for (int q = 0; q < 4; q++) {
+			EXPECT_EQ(store->hpq(p, q), repacked.hpq(p, q));
+			for (int r = 0; r < 4; r++) {
+				for (int s = 0; s < 4; s++) {
+					EXPECT_EQ(store->hpqrs(p, q, r, s), repacked.hpqrs(p, q, r, s));
+				}
+			}
+		}
+	}
+
+	// Listing every permutation of an integral changes nothing
+	std::string redundant = "&FCI NORB=2, NELEC=2,\n/\n"
+			"0.1812104620151246 1 2 1 2\n0.1812104620151246 2 1 2 1\n"
+			"0.1812104620151246 1 2 2 1\n0.1812104620151246 2 1 1 2\n";
+	FermionOperator a, b;
+	parser.parse(redundant, a);
+	parser.parse("&FCI NORB=2,NELEC=2 &END\n 0.1812104620151246 2 1 2 1", b);
+	EXPECT_EQ(12, a.nTerms());
+	EXPECT_EQ(a.nTerms(), b.nTerms());
+
+	EXPECT_XACC_ERROR(parser.parse("&FCI NORB=2 &END\n 0.5 3 1 1 1", a));
+
+	// Plain kernels leave no integrals behind
+	parser.parse("1.0 0 1 0 0", a);
+	EXPECT_FALSE(bool(parser.getIntegrals()));
+	EXPECT_EQ(-1, parser.getNElectrons());
+}
+
+int main(int argc, char** argv) {
+   ::testing::InitGoogleTest(&argc, argv);
+   return RUN_ALL_TESTS();
+}
@@ -32,7 +32,7 @@
 #define QUANTUM_AQC_FermionKERNEL_HPP_
 
 #include "Function.hpp"
-#include "FermionInstruction.hpp"
+#include "IntegralStore.hpp"
 #include "XACC.hpp"
 #include "unsupported/Eigen/CXX11/Tensor"
 
@@ -41,22 +41,42 @@ namespace vqe {
 
 /**
  * The FermionKernel is an XACC Function that represents
- * a sum of FermionInstructions.
+ * a sum of FermionInstructions. It is a view over a
+ * FermionOperator, which holds the terms; FermionInstructions
+ * are only built when requested through the Function
+ * interface, and are copies of the stored terms.
  */
 class FermionKernel: public virtual Function {
 
 protected:
 
 	/**
-	 * List of FermionInstructions
+	 * The terms of this kernel
 	 */
-	std::list<InstPtr> instructions;
+	std::shared_ptr<FermionOperator> op;
+
+	/**
+	 * The packed integrals of op, built on first use
+	 */
+	std::shared_ptr<const IntegralStore> integralStore;
+
+	/**
+	 * The qubit each mode was placed on, empty if the
+	 * modes were not reordered
+	 */
+	std::vector<int> modePermutation;
 
 	/**
 	 * This function's name
 	 */
 	std::string _name;
 
+	void checkIndex(const int idx) {
+		if (idx < 0 || idx >= op->nTerms()) {
+			xacc::error("Invalid instruction index.");
+		}
+	}
+
 public:
 
 	/**
@@ -65,7 +85,31 @@ public:
 	 * @param id
 	 * @param name
 	 */
-	FermionKernel(std::string kernelName) : _name(kernelName) {
+	FermionKernel(std::string kernelName) :
+			op(std::make_shared<FermionOperator>()), _name(kernelName) {
+	}
+
+	/**
+	 * The constructor, takes the function name and the
+	 * FermionOperator it views.
+	 *
+	 * @param kernelName The function name
+	 * @param fermionOp The terms
+	 */
+	FermionKernel(std::string kernelName,
+			std::shared_ptr<FermionOperator> fermionOp) :
+			op(fermionOp), _name(kernelName) {
+	}
+
+	/**
+	 * Return the FermionOperator holding this kernel's terms.
+	 */
+	FermionOperator& getOperator() {
+		return *op;
+	}
+
+	std::shared_ptr<FermionOperator> getOperatorPtr() {
+		return op;
 	}
 
 	/**
@@ -74,7 +118,7 @@ public:
 	 * @return
 	 */
 	virtual const int nInstructions() {
-		return instructions.size();
+		return op->nTerms();
 	}
 
 	/**
@@ -84,24 +128,24 @@ public:
 	 * @return instruction
 	 */
 	virtual InstPtr getInstruction(const int idx) {
-		InstPtr ptr;
-		if (instructions.size() > idx) {
-			ptr = *std::next(instructions.begin(), idx);
-		} else {
-			xacc::error("Invalid instruction index.");
-		}
-		return ptr;
+		checkIndex(idx);
+		return op->instruction(idx);
 	}
 
 	virtual void mapBits(std::vector<int> bitMap) {
 	}
 
 	/**
-	 * Return all FermionInstruction
+	 * Return all FermionInstruction. This builds every
+	 * instruction, prefer getOperator().
 	 *
 	 * @return instructions
 	 */
 	virtual std::list<InstPtr> getInstructions() {
+		std::list<InstPtr> instructions;
+		for (std::size_t i = 0; i < op->nTerms(); i++) {
+			instructions.push_back(op->instruction(i));
+		}
 		return instructions;
 	}
 
@@ -111,7 +155,9 @@ public:
 	 * @param idx The index of the instruction to remove.
 	 */
 	virtual void removeInstruction(const int idx) {
-		instructions.remove(getInstruction(idx));
+		checkIndex(idx);
+		op->eraseTerm(idx);
+		integralStore.reset();
 	}
 
 	/**
@@ -121,7 +167,8 @@ public:
 	 * @param instruction
 	 */
 	virtual void addInstruction(InstPtr instruction) {
-		instructions.push_back(instruction);
+		op->addTerm(*instruction);
+		integralStore.reset();
 	}
 
 	/**
@@ -132,8 +179,10 @@ public:
 	 * @param replacingInst
 	 */
 	virtual void replaceInstruction(const int idx, InstPtr replacingInst) {
-		std::replace(instructions.begin(), instructions.end(),
-				getInstruction(idx), replacingInst);
+		checkIndex(idx);
+		op->eraseTerm(idx);
+		op->insertTerm(idx, *replacingInst);
+		integralStore.reset();
 	}
 
 	/**
@@ -143,8 +192,11 @@ public:
 	 * @param newInst
 	 */
 	virtual void insertInstruction(const int idx, InstPtr newInst) {
-		auto iter = std::next(instructions.begin(), idx);
-		instructions.insert(iter, newInst);
+		if (idx < 0 || idx > op->nTerms()) {
+			xacc::error("Invalid instruction index.");
+		}
+		op->insertTerm(idx, *newInst);
+		integralStore.reset();
 	}
 
 	/**
@@ -167,83 +219,60 @@ public:
 		return std::vector<int> { };
 	}
 
-	const double E_nuc() {
-		auto instructions = getInstructions();
-		auto instVec = std::vector<InstPtr>(instructions.begin(), instructions.end());
-
-		double e = 0.0;
-		// Loop over all Fermionic terms...
-		for (int z = 0; z < instructions.size(); ++z) {
-
-			auto f = instVec[z];
-
-			// Get the creation or annihilation sites
-			auto termSites = f->bits();
-			auto params = f->getParameters();
-			auto coeff = boost::get<std::complex<double>>(params[f->nParameters() - 2]);
-
-			if (termSites.empty()) {
-				e = std::real(coeff);
-			}
-		}
-		return e;
+	/**
+	 * Record that the terms were moved from each mode m to
+	 * site permutation[m], the qubit that mode is placed on.
+	 */
+	void setModePermutation(const std::vector<int>& permutation) {
+		modePermutation = permutation;
 	}
 
-	Eigen::Tensor<std::complex<double>, 2> hpq(const int nQubits) {
-		Eigen::Tensor<std::complex<double>, 2> hpq(nQubits, nQubits);
-		hpq.setZero();
-
-		auto instructions = getInstructions();
-		auto instVec = std::vector<InstPtr>(instructions.begin(), instructions.end());
-
-		// Loop over all Fermionic terms...
-		for (int z = 0; z < instructions.size(); ++z) {
+	/**
+	 * Return the qubit each mode was placed on, or an empty
+	 * vector if the modes were not reordered.
+	 */
+	const std::vector<int>& getModePermutation() const {
+		return modePermutation;
+	}
 
-			auto f = instVec[z];
+	/**
+	 * (Re)build the packed integrals from the current terms.
+	 * Edits made through getOperator() are only seen after
+	 * calling this.
+	 */
+	void buildIntegrals() {
+		integralStore = std::make_shared<const IntegralStore>(*op);
+	}
 
-			// Get the creation or annihilation sites
-			auto termSites = f->bits();
-			auto params = f->getParameters();
-			auto coeff = boost::get<std::complex<double>>(params[f->nParameters() - 2]);
+	/**
+	 * Use integrals that were already packed, for instance
+	 * the ones this kernel's terms were expanded from.
+	 */
+	void setIntegrals(std::shared_ptr<const IntegralStore> store) {
+		integralStore = store;
+	}
 
-			if (termSites.size() == 2) {
-				int p = termSites[0];
-				int q = termSites[1];
-				hpq(p,q) = coeff;
-			}
+	/**
+	 * Return the packed one- and two-electron integrals
+	 * of this kernel, building them if needed.
+	 */
+	std::shared_ptr<const IntegralStore> integrals() {
+		if (!integralStore) {
+			buildIntegrals();
 		}
-
-		return hpq;
+		return integralStore;
 	}
 
-	Eigen::Tensor<std::complex<double>, 4> hpqrs(const int nQubits) {
-
-		Eigen::Tensor<std::complex<double>, 4> hpqrs(nQubits, nQubits, nQubits, nQubits);
-		hpqrs.setZero();
-
-		auto instructions = getInstructions();
-		auto instVec = std::vector<InstPtr>(instructions.begin(), instructions.end());
-
-		// Loop over all Fermionic terms...
-		for (int z = 0; z < instructions.size(); ++z) {
-
-			auto f = instVec[z];
-
-			// Get the creation or annihilation sites
-			auto termSites = f->bits();
-			auto params = f->getParameters();
-			auto coeff = boost::get<std::complex<double>>(params[f->nParameters() - 2]);
+	const double E_nuc() {
+		return integrals()->nuclearEnergy();
+	}
 
-			if (termSites.size() == 4) {
-				int p = termSites[0];
-				int q = termSites[1];
-				int r = termSites[2];
-				int s = termSites[3];
-				hpqrs(p,q,r,s) = coeff;
-			}
-		}
+	OneBodyIntegrals hpq(const int nQubits) {
+		return OneBodyIntegrals(integrals(), nQubits);
+	}
 
-		return hpqrs;
+	TwoBodyIntegrals hpqrs(const int nQubits) {
+		return TwoBodyIntegrals(integrals(), nQubits);
 	}
 
 	/**
@@ -253,8 +282,8 @@ public:
 	 */
 	virtual const std::string toString(const std::string& bufferVarName) {
 		std::stringstream ss;
-		for (auto i : instructions) {
-			ss << i->toString("") << " + \n";
+		for (std::size_t i = 0; i < op->nTerms(); i++) {
+			ss << op->instruction(i)->toString("") << " + \n";
 		}
 		return ss.str().substr(0, ss.str().size() - 3);
 	}
@@ -0,0 +1,494 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_FERMIONOPERATOR_HPP_
+#define VQE_IR_FERMIONOPERATOR_HPP_
+
+#include "FermionInstruction.hpp"
+#include <cstdint>
+#include <unordered_map>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The FermionOperator is a flat, structure-of-arrays sum of
+ * products of creation and annihilation operators. Term i owns
+ * the sites [offsets[i], offsets[i+1]) of one shared site array,
+ * bit k of its creation mask is set if its kth operator is a
+ * creation operator, and its coefficient and interned variable
+ * id sit in parallel arrays. Any term is reached in O(1), and a
+ * two-body term costs under 50 bytes.
+ */
+class FermionOperator {
+
+public:
+
+	/**
+	 * The largest number of ladder operators in one term.
+	 */
+	static const int MaxOperators = 32;
+
+protected:
+
+	std::vector<std::uint32_t> offsets { 0 };
+	std::vector<std::int32_t> siteArray;
+	std::vector<std::uint32_t> creationMasks;
+	std::vector<std::complex<double>> coeffArray;
+	std::vector<std::int32_t> varIdArray;
+
+	/**
+	 * The interned variable names, indexed by id.
+	 */
+	std::vector<std::string> variables;
+	std::unordered_map<std::string, std::int32_t> variableIds;
+
+	static void checkSize(const int n) {
+		if (n > MaxOperators) {
+			xacc::error("FermionOperator terms hold at most "
+					+ std::to_string(MaxOperators) + " ladder operators.");
+		}
+	}
+
+	friend class FermionKernelParser;
+
+	/**
+	 * A term being normal ordered, as (site, creation) pairs.
+	 */
+	struct LadderTerm {
+		std::vector<std::pair<std::int32_t, bool>> ops;
+		std::complex<double> coeff;
+		std::int32_t varId;
+	};
+
+	/**
+	 * Bring t into normal order by adjacent swaps, pushing the
+	 * terms that the anticommutator of a_p a_p^+ leaves behind
+	 * onto pending. Return false if t vanishes.
+	 */
+	static bool normalOrder(LadderTerm& t, std::vector<LadderTerm>& pending) {
+		auto& ops = t.ops;
+		for (std::size_t i = 1; i < ops.size(); i++) {
+			for (std::size_t j = i; j > 0; j--) {
+				auto& left = ops[j - 1];
+				auto& right = ops[j];
+				if (right.second && !left.second) {
+					if (left.first == right.first) {
+						// a_p a_p^+ = 1 - a_p^+ a_p
+						LadderTerm rest { ops, t.coeff, t.varId };
+						rest.ops.erase(rest.ops.begin() + j - 1,
+								rest.ops.begin() + j + 1);
+						pending.push_back(std::move(rest));
+					}
+					std::swap(left, right);
+					t.coeff = -t.coeff;
+				} else if (right.second == left.second) {
+					if (right.first == left.first) {
+						return false;
+					}
+					if (right.first > left.first) {
+						std::swap(left, right);
+						t.coeff = -t.coeff;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Return a key identifying the operators and variable of
+	 * a normal ordered term.
+	 */
+	static std::string termKey(const std::vector<std::pair<std::int32_t, bool>>& ops,
+			const std::int32_t varId) {
+		std::string key(reinterpret_cast<const char*>(&varId), sizeof(varId));
+		for (auto& op : ops) {
+			std::int32_t s = op.second ? op.first : -1 - op.first;
+			key.append(reinterpret_cast<const char*>(&s), sizeof(s));
+		}
+		return key;
+	}
+
+public:
+
+	std::size_t nTerms() const {
+		return coeffArray.size();
+	}
+
+	bool empty() const {
+		return coeffArray.empty();
+	}
+
+	/**
+	 * Return the number of ladder operators over all terms.
+	 */
+	std::size_t nSites() const {
+		return siteArray.size();
+	}
+
+	/**
+	 * Reserve room for n terms with nOperators ladder
+	 * operators in total.
+	 */
+	void reserve(const std::size_t n, const std::size_t nOperators) {
+		offsets.reserve(n + 1);
+		siteArray.reserve(nOperators);
+		creationMasks.reserve(n);
+		coeffArray.reserve(n);
+		varIdArray.reserve(n);
+	}
+
+	void clear() {
+		offsets.assign(1, 0);
+		siteArray.clear();
+		creationMasks.clear();
+		coeffArray.clear();
+		varIdArray.clear();
+		variables.clear();
+		variableIds.clear();
+	}
+
+	/**
+	 * Return the id of the given variable, adding it if new.
+	 * The empty variable has id -1.
+	 */
+	std::int32_t internVariable(const std::string& name) {
+		if (name.empty()) {
+			return -1;
+		}
+		auto it = variableIds.find(name);
+		if (it != variableIds.end()) {
+			return it->second;
+		}
+		std::int32_t id = variables.size();
+		variables.push_back(name);
+		variableIds.insert( { name, id });
+		return id;
+	}
+
+	const std::vector<std::string>& getVariables() const {
+		return variables;
+	}
+
+	/**
+	 * Append a term.
+	 *
+	 * @param sites The n operator sites
+	 * @param n The number of ladder operators
+	 * @param creationMask Bit k set if operator k is a creation
+	 * @param coeff The term coefficient
+	 * @param varId The interned variable id, or -1
+	 */
+	void addTerm(const std::int32_t* sites, const int n,
+			const std::uint32_t creationMask, const std::complex<double> coeff,
+			const std::int32_t varId = -1) {
+		checkSize(n);
+		siteArray.insert(siteArray.end(), sites, sites + n);
+		offsets.push_back(siteArray.size());
+		creationMasks.push_back(creationMask);
+		coeffArray.push_back(coeff);
+		varIdArray.push_back(varId);
+	}
+
+	/**
+	 * Append a term given as (site, creation) pairs.
+	 */
+	void addTerm(const std::vector<std::pair<int, int>>& operators,
+			const std::complex<double> coeff, const std::string& var = "") {
+		checkSize(operators.size());
+		std::uint32_t mask = 0;
+		for (int k = 0; k < operators.size(); k++) {
+			siteArray.push_back(operators[k].first);
+			mask |= std::uint32_t(operators[k].second ? 1 : 0) << k;
+		}
+		offsets.push_back(siteArray.size());
+		creationMasks.push_back(mask);
+		coeffArray.push_back(coeff);
+		varIdArray.push_back(internVariable(var));
+	}
+
+	/**
+	 * Append the term described by a FermionInstruction.
+	 */
+	void addTerm(Instruction& inst) {
+		insertTerm(nTerms(), inst);
+	}
+
+	/**
+	 * Insert the term described by a FermionInstruction
+	 * before term idx.
+	 */
+	void insertTerm(const std::size_t idx, Instruction& inst) {
+		auto sites = inst.bits();
+		auto n = inst.nParameters();
+		checkSize(sites.size());
+		std::uint32_t mask = 0;
+		for (int k = 0; k < sites.size(); k++) {
+			mask |= std::uint32_t(boost::get<int>(inst.getParameter(k)) ? 1 : 0) << k;
+		}
+		auto coeff = boost::get<std::complex<double>>(inst.getParameter(n - 2));
+		auto varId = internVariable(boost::get<std::string>(inst.getParameter(n - 1)));
+
+		auto at = offsets[idx];
+		siteArray.insert(siteArray.begin() + at, sites.begin(), sites.end());
+		offsets.insert(offsets.begin() + idx + 1, at + sites.size());
+		for (auto i = idx + 2; i < offsets.size(); i++) {
+			offsets[i] += sites.size();
+		}
+		creationMasks.insert(creationMasks.begin() + idx, mask);
+		coeffArray.insert(coeffArray.begin() + idx, coeff);
+		varIdArray.insert(varIdArray.begin() + idx, varId);
+	}
+
+	/**
+	 * Remove term idx.
+	 */
+	void eraseTerm(const std::size_t idx) {
+		auto n = nOperators(idx);
+		siteArray.erase(siteArray.begin() + offsets[idx],
+				siteArray.begin() + offsets[idx + 1]);
+		offsets.erase(offsets.begin() + idx + 1);
+		for (auto i = idx + 1; i < offsets.size(); i++) {
+			offsets[i] -= n;
+		}
+		creationMasks.erase(creationMasks.begin() + idx);
+		coeffArray.erase(coeffArray.begin() + idx);
+		varIdArray.erase(varIdArray.begin() + idx);
+	}
+
+	/**
+	 * Return the number of ladder operators in term i.
+	 */
+	int nOperators(const std::size_t i) const {
+		return offsets[i + 1] - offsets[i];
+	}
+
+	/**
+	 * Return a pointer to the nOperators(i) sites of term i.
+	 */
+	const std::int32_t* sites(const std::size_t i) const {
+		return siteArray.data() + offsets[i];
+	}
+
+	int site(const std::size_t i, const int k) const {
+		return siteArray[offsets[i] + k];
+	}
+
+	std::uint32_t creationMask(const std::size_t i) const {
+		return creationMasks[i];
+	}
+
+	bool isCreation(const std::size_t i, const int k) const {
+		return (creationMasks[i] >> k) & 1;
+	}
+
+	const std::complex<double>& coeff(const std::size_t i) const {
+		return coeffArray[i];
+	}
+
+	std::complex<double>& coeff(const std::size_t i) {
+		return coeffArray[i];
+	}
+
+	std::int32_t varId(const std::size_t i) const {
+		return varIdArray[i];
+	}
+
+	/**
+	 * Return the variable of term i, empty if it has none.
+	 */
+	const std::string& var(const std::size_t i) const {
+		static const std::string none;
+		return varIdArray[i] < 0 ? none : variables[varIdArray[i]];
+	}
+
+	/**
+	 * Return the largest site acted on, or -1.
+	 */
+	int maxSite() const {
+		int m = -1;
+		for (auto s : siteArray) {
+			m = std::max<int>(m, s);
+		}
+		return m;
+	}
+
+	/**
+	 * Move every operator on site m to site permutation[m].
+	 */
+	void permuteSites(const std::vector<int>& permutation) {
+		for (auto& s : siteArray) {
+			s = permutation[s];
+		}
+	}
+
+	/**
+	 * Return term i as (site, creation) pairs.
+	 */
+	std::vector<std::pair<int, int>> operators(const std::size_t i) const {
+		std::vector<std::pair<int, int>> ops;
+		for (int k = 0; k < nOperators(i); k++) {
+			ops.push_back( { site(i, k), isCreation(i, k) ? 1 : 0 });
+		}
+		return ops;
+	}
+
+	/**
+	 * Return this operator in normal order with like terms
+	 * merged. Creation operators are moved before annihilation
+	 * operators, each group in descending site order, using the
+	 * anticommutation relations, and products that repeat a ladder
+	 * operator vanish. Terms with the same operators and variable
+	 * are then summed, and those below tol dropped.
+	 *
+	 * If conjugates is given, each term is also folded together
+	 * with its hermitian conjugate: term i of the result stands for
+	 * coeff(i) T_i + (*conjugates)[i] T_i^+, and self-adjoint terms
+	 * get a zero conjugate coefficient.
+	 *
+	 * @param conjugates The conjugate coefficients, or null
+	 * @param tol The magnitude below which terms are dropped
+	 * @return ordered The reduced operator
+	 */
+	FermionOperator normalOrdered(
+			std::vector<std::complex<double>>* conjugates = nullptr,
+			const double tol = 1e-12) const {
+
+		if (conjugates) {
+			conjugates->clear();
+		}
+
+		// Normal order every term, summing like terms
+		std::vector<LadderTerm> merged, pending;
+		std::unordered_map<std::string, std::size_t> index;
+		for (std::size_t i = 0; i < nTerms(); i++) {
+			LadderTerm t { { }, coeff(i), varIdArray[i] };
+			for (int k = 0; k < nOperators(i); k++) {
+				t.ops.push_back( { site(i, k), isCreation(i, k) });
+			}
+			pending.push_back(std::move(t));
+			while (!pending.empty()) {
+				auto term = std::move(pending.back());
+				pending.pop_back();
+				if (!normalOrder(term, pending)) {
+					continue;
+				}
+				auto key = termKey(term.ops, term.varId);
+				auto it = index.find(key);
+				if (it == index.end()) {
+					index.insert( { key, merged.size() });
+					merged.push_back(std::move(term));
+				} else {
+					merged[it->second].coeff += term.coeff;
+				}
+			}
+		}
+
+		// Fold T^+ into T. With m creations and n annihilations,
+		// reversing both groups of T^+ into normal order gives a
+		// sign of (-1)^(m(m-1)/2 + n(n-1)/2)
+		std::vector<std::complex<double>> conj(merged.size());
+		std::vector<bool> folded(merged.size(), false);
+		if (conjugates) {
+			for (std::size_t i = 0; i < merged.size(); i++) {
+				if (folded[i]) {
+					continue;
+				}
+				auto& ops = merged[i].ops;
+				std::vector<std::pair<std::int32_t, bool>> adjoint;
+				std::size_t m = 0;
+				for (auto& op : ops) {
+					if (!op.second) {
+						adjoint.push_back( { op.first, true });
+					} else {
+						m++;
+					}
+				}
+				for (auto& op : ops) {
+					if (op.second) {
+						adjoint.push_back( { op.first, false });
+					}
+				}
+				auto n = ops.size() - m;
+				auto it = index.find(termKey(adjoint, merged[i].varId));
+				if (it == index.end() || it->second == i) {
+					continue;
+				}
+				auto sign = ((m * (m - 1) / 2 + n * (n - 1) / 2) % 2) ? -1.0 : 1.0;
+				conj[i] = sign * merged[it->second].coeff;
+				folded[it->second] = true;
+			}
+		}
+
+		FermionOperator result;
+		for (auto& v : variables) {
+			result.internVariable(v);
+		}
+		for (std::size_t i = 0; i < merged.size(); i++) {
+			if (folded[i] || (std::abs(merged[i].coeff) < tol
+					&& std::abs(conj[i]) < tol)) {
+				continue;
+			}
+			std::int32_t sites[MaxOperators];
+			std::uint32_t mask = 0;
+			auto& ops = merged[i].ops;
+			for (std::size_t k = 0; k < ops.size(); k++) {
+				sites[k] = ops[k].first;
+				mask |= std::uint32_t(ops[k].second ? 1 : 0) << k;
+			}
+			result.addTerm(sites, ops.size(), mask, merged[i].coeff,
+					merged[i].varId);
+			if (conjugates) {
+				conjugates->push_back(conj[i]);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Build a FermionInstruction holding a copy of term i.
+	 */
+	std::shared_ptr<FermionInstruction> instruction(const std::size_t i) const {
+		auto inst = std::make_shared<FermionInstruction>(operators(i), coeff(i));
+		if (varIdArray[i] >= 0) {
+			InstructionParameter p(var(i));
+			inst->setParameter(inst->nParameters() - 1, p);
+		}
+		return inst;
+	}
+};
+
+}
+
+}
+
+#endif
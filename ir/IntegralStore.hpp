@@ -0,0 +1,751 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_INTEGRALSTORE_HPP_
+#define VQE_IR_INTEGRALSTORE_HPP_
+
+#include "FermionOperator.hpp"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include <map>
+#include <unordered_set>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The IntegralStore holds the one- and two-electron integrals
+ * of a molecular FermionOperator, packed by permutational
+ * symmetry. Spin orbitals are interleaved, 2i for alpha and
+ * 2i + 1 for beta, so the spin-conserving term c a_P^+ a_Q gives
+ * h(p,q) = c and c a_P^+ a_Q^+ a_R a_S gives the chemists'
+ * integral (ps|qr) = 2c. Real spatial integrals satisfy
+ * h(p,q) = h(q,p) and the 8-fold symmetry of (pq|rs), so only
+ * entries with p >= q, r >= s and pq >= rs are kept. Two-body
+ * entries are sorted by their leading pair pq, so each (pq| block
+ * is contiguous and lookups are a binary search within a block.
+ *
+ * Terms that do not fit this picture (complex, spin-flipping or
+ * parameterized terms, other operator orders, or integrals not
+ * given at every equivalent index order with the same value)
+ * are kept verbatim by spin-orbital index and take precedence
+ * on lookup.
+ */
+class IntegralStore {
+
+public:
+
+	/**
+	 * A unique one-electron integral h(p,q), p >= q.
+	 */
+	struct OneBodyIntegral {
+		std::uint32_t p;
+		std::uint32_t q;
+		double value;
+	};
+
+	/**
+	 * A unique two-electron integral (pq|rs), p >= q,
+	 * r >= s and pq >= rs, with its packed key.
+	 */
+	struct TwoBodyIntegral {
+		std::uint64_t key;
+		std::uint16_t p;
+		std::uint16_t q;
+		std::uint16_t r;
+		std::uint16_t s;
+		double value;
+	};
+
+	/**
+	 * The contiguous run of unique integrals (pq|rs)
+	 * sharing one leading pair pq.
+	 */
+	class Block {
+
+	protected:
+
+		const TwoBodyIntegral* first;
+		const TwoBodyIntegral* last;
+
+	public:
+
+		Block(const TwoBodyIntegral* f, const TwoBodyIntegral* l) :
+				first(f), last(l) {
+		}
+
+		const TwoBodyIntegral* begin() const {
+			return first;
+		}
+
+		const TwoBodyIntegral* end() const {
+			return last;
+		}
+
+		std::size_t size() const {
+			return last - first;
+		}
+
+		bool empty() const {
+			return first == last;
+		}
+	};
+
+protected:
+
+	using Residual = std::vector<std::pair<std::uint64_t, std::complex<double>>>;
+
+	int nSpatial = 0;
+
+	double eNuc = 0.0;
+
+	/**
+	 * The unique integrals, sorted by pair index and key.
+	 */
+	std::vector<OneBodyIntegral> oneBody;
+	std::vector<TwoBodyIntegral> twoBody;
+
+	/**
+	 * Block pq of twoBody is [blockPtr[pq], blockPtr[pq + 1]).
+	 */
+	std::vector<std::uint32_t> blockPtr { 0 };
+
+	/**
+	 * Terms kept by spin-orbital index, sorted by packed sites.
+	 */
+	Residual residualOneBody;
+	Residual residualTwoBody;
+
+	static std::uint64_t pairIndex(std::uint64_t p, std::uint64_t q) {
+		if (p < q) {
+			std::swap(p, q);
+		}
+		return p * (p + 1) / 2 + q;
+	}
+
+	static std::uint64_t twoBodyKey(const int p, const int q, const int r,
+			const int s) {
+		return pairIndex(pairIndex(p, q), pairIndex(r, s));
+	}
+
+	static std::uint64_t siteKey(const std::int32_t* sites, const int n) {
+		std::uint64_t key = 0;
+		for (int k = 0; k < n; k++) {
+			key = (key << 16) | std::uint64_t(sites[k]);
+		}
+		return key;
+	}
+
+	/**
+	 * Return (pq|rs) in its canonical index order.
+	 */
+	static TwoBodyIntegral canonical(int p, int q, int r, int s,
+			const double value) {
+		if (p < q) {
+			std::swap(p, q);
+		}
+		if (r < s) {
+			std::swap(r, s);
+		}
+		if (pairIndex(p, q) < pairIndex(r, s)) {
+			std::swap(p, r);
+			std::swap(q, s);
+		}
+		return {twoBodyKey(p, q, r, s), std::uint16_t(p), std::uint16_t(q),
+			std::uint16_t(r), std::uint16_t(s), value};
+	}
+
+	/**
+	 * Call f(sites) for the spin orbital orders a_P^+ a_Q
+	 * that carry the one-electron integral e.
+	 */
+	template<typename F>
+	static void forEachOrder(const OneBodyIntegral& e, F f) {
+		std::int32_t sites[2];
+		for (int sigma = 0; sigma < 2; sigma++) {
+			sites[0] = 2 * e.p + sigma;
+			sites[1] = 2 * e.q + sigma;
+			f(sites);
+			if (e.p != e.q) {
+				std::swap(sites[0], sites[1]);
+				f(sites);
+			}
+		}
+	}
+
+	/**
+	 * Call f(sites) for the spin-conserving spin orbital orders
+	 * a_P^+ a_Q^+ a_R a_S that carry (ps|qr) / 2 for the
+	 * two-electron integral e, including those that vanish
+	 * because a spin orbital repeats.
+	 */
+	template<typename F>
+	static void forEachOrder(const TwoBodyIntegral& e, F f) {
+		// The distinct index orders sharing (pq|rs)
+		const int perms[8][4] = { { e.p, e.q, e.r, e.s },
+				{ e.q, e.p, e.r, e.s }, { e.p, e.q, e.s, e.r },
+				{ e.q, e.p, e.s, e.r }, { e.r, e.s, e.p, e.q },
+				{ e.s, e.r, e.p, e.q }, { e.r, e.s, e.q, e.p },
+				{ e.s, e.r, e.q, e.p } };
+		std::int32_t sites[4];
+		for (int k = 0; k < 8; k++) {
+			auto o = perms[k];
+			bool seen = false;
+			for (int m = 0; m < k && !seen; m++) {
+				seen = std::equal(o, o + 4, perms[m]);
+			}
+			if (seen) {
+				continue;
+			}
+			for (int sigma = 0; sigma < 2; sigma++) {
+				for (int tau = 0; tau < 2; tau++) {
+					sites[0] = 2 * o[0] + sigma;
+					sites[1] = 2 * o[2] + tau;
+					sites[2] = 2 * o[3] + tau;
+					sites[3] = 2 * o[1] + sigma;
+					f(sites);
+				}
+			}
+		}
+	}
+
+	static bool vanishes(const std::int32_t* sites) {
+		return sites[0] == sites[1] || sites[2] == sites[3];
+	}
+
+	/**
+	 * Sort the unique integrals and index the two-body blocks.
+	 */
+	void index() {
+		std::sort(oneBody.begin(), oneBody.end(),
+				[](const OneBodyIntegral& a, const OneBodyIntegral& b) {
+					return pairIndex(a.p, a.q) < pairIndex(b.p, b.q);
+				});
+		std::sort(twoBody.begin(), twoBody.end(),
+				[](const TwoBodyIntegral& a, const TwoBodyIntegral& b) {
+					return a.key < b.key;
+				});
+
+		blockPtr.assign(nPairs() + 1, 0);
+		for (auto& e : twoBody) {
+			blockPtr[pairIndex(e.p, e.q) + 1]++;
+		}
+		for (std::size_t b = 0; b < nPairs(); b++) {
+			blockPtr[b + 1] += blockPtr[b];
+		}
+	}
+
+	/**
+	 * Call f(sites, n, creationMask, coeff) for every spin-orbital
+	 * term of this Hamiltonian, skipping terms that vanish because
+	 * they create or annihilate the same spin orbital twice.
+	 */
+	template<typename F>
+	void forEachSpinOrbitalTerm(F f, const double tol) const {
+		if (std::fabs(eNuc) >= tol) {
+			f(nullptr, 0, 0, eNuc);
+		}
+
+		for (auto& e : oneBody) {
+			if (std::fabs(e.value) >= tol) {
+				forEachOrder(e, [&](const std::int32_t* sites) {
+					f(sites, 2, 1, e.value);
+				});
+			}
+		}
+
+		for (auto& e : twoBody) {
+			if (std::fabs(e.value) >= tol) {
+				forEachOrder(e, [&](const std::int32_t* sites) {
+					if (!vanishes(sites)) {
+						f(sites, 4, 3, 0.5 * e.value);
+					}
+				});
+			}
+		}
+
+		std::int32_t sites[4];
+		for (auto& r : residualOneBody) {
+			sites[0] = r.first >> 16;
+			sites[1] = r.first & 0xFFFF;
+			f(sites, 2, 1, r.second);
+		}
+		for (auto& r : residualTwoBody) {
+			sites[0] = r.first >> 48;
+			sites[1] = (r.first >> 32) & 0xFFFF;
+			sites[2] = (r.first >> 16) & 0xFFFF;
+			sites[3] = r.first & 0xFFFF;
+			f(sites, 4, 3, r.second);
+		}
+	}
+
+	static const std::complex<double>* findResidual(const Residual& residual,
+			const std::uint64_t key) {
+		auto it = std::lower_bound(residual.begin(), residual.end(),
+				std::make_pair(key, std::complex<double>()),
+				[](const Residual::value_type& a, const Residual::value_type& b) {
+					return a.first < b.first;
+				});
+		return it != residual.end() && it->first == key ? &it->second : nullptr;
+	}
+
+	bool inRange(const int p) const {
+		return p >= 0 && p < 2 * nSpatial;
+	}
+
+public:
+
+	IntegralStore() {
+	}
+
+	/**
+	 * Build the store from the terms of a FermionOperator. As
+	 * for a dense tensor, a later term at the same spin-orbital
+	 * indices replaces an earlier one. An integral is packed only
+	 * if the operator holds it at every equivalent spin orbital
+	 * order (both spins, both orders of h(p,q) and all 8 orders
+	 * of (pq|rs)) with the same value, otherwise its terms are
+	 * kept verbatim, so the store always reproduces op.
+	 *
+	 * @param op The molecular Hamiltonian
+	 * @param tol The tolerance for real and symmetric values
+	 */
+	explicit IntegralStore(const FermionOperator& op, const double tol = 1e-12) {
+		auto maxSite = op.maxSite();
+		if (maxSite > 0xFFFF) {
+			xacc::error("IntegralStore supports at most 65536 spin orbitals.");
+		}
+		nSpatial = (maxSite + 2) / 2;
+
+		// The terms by sites, flagged if they could be part of an integral
+		using Terms = std::map<std::uint64_t, std::pair<std::complex<double>, bool>>;
+		Terms one, two;
+		for (std::size_t i = 0; i < op.nTerms(); i++) {
+			auto n = op.nOperators(i);
+			auto s = op.sites(i);
+			auto c = op.coeff(i);
+			if (n == 0) {
+				eNuc = std::real(c);
+				continue;
+			} else if (n != 2 && n != 4) {
+				continue;
+			}
+
+			bool packable = op.varId(i) < 0 && std::fabs(c.imag()) < tol
+					&& op.creationMask(i) == (n == 2 ? 1 : 3);
+			if (n == 2) {
+				packable = packable && s[0] % 2 == s[1] % 2;
+				one[siteKey(s, 2)] = std::make_pair(c, packable);
+			} else {
+				packable = packable && s[0] % 2 == s[3] % 2 && s[1] % 2 == s[2] % 2;
+				two[siteKey(s, 4)] = std::make_pair(c, packable);
+			}
+		}
+
+		// One candidate integral per spatial index set
+		std::unordered_set<std::uint64_t> seen;
+		std::vector<OneBodyIntegral> oneCandidates;
+		for (auto& t : one) {
+			std::uint32_t p = (t.first >> 16) / 2, q = (t.first & 0xFFFF) / 2;
+			if (t.second.second && seen.insert(pairIndex(p, q)).second) {
+				oneCandidates.push_back( { std::max(p, q), std::min(p, q),
+						t.second.first.real() });
+			}
+		}
+		seen.clear();
+		std::vector<TwoBodyIntegral> twoCandidates;
+		for (auto& t : two) {
+			std::int32_t s[4] = { std::int32_t(t.first >> 48), std::int32_t(
+					(t.first >> 32) & 0xFFFF), std::int32_t((t.first >> 16) & 0xFFFF),
+					std::int32_t(t.first & 0xFFFF) };
+			if (!t.second.second || vanishes(s)) {
+				continue;
+			}
+			// a_P^+ a_Q^+ a_R a_S carries (ps|qr) / 2
+			auto e = canonical(s[0] / 2, s[3] / 2, s[1] / 2, s[2] / 2,
+					2.0 * t.second.first.real());
+			if (seen.insert(e.key).second) {
+				twoCandidates.push_back(e);
+			}
+		}
+
+		// Keep the candidates whose orders are all present, and
+		// drop the terms they reproduce
+		auto matches = [&](const Terms& terms, const std::int32_t* sites,
+				const int n, const double value) {
+			auto it = terms.find(siteKey(sites, n));
+			return it != terms.end() && it->second.second
+					&& std::fabs(it->second.first.real() - value) < tol;
+		};
+		for (auto& e : oneCandidates) {
+			bool complete = true;
+			forEachOrder(e, [&](const std::int32_t* sites) {
+				complete = complete && matches(one, sites, 2, e.value);
+			});
+			if (complete) {
+				oneBody.push_back(e);
+				forEachOrder(e, [&](const std::int32_t* sites) {
+					one.erase(siteKey(sites, 2));
+				});
+			}
+		}
+		for (auto& e : twoCandidates) {
+			bool complete = true;
+			forEachOrder(e, [&](const std::int32_t* sites) {
+				complete = complete
+						&& (vanishes(sites) || matches(two, sites, 4, 0.5 * e.value));
+			});
+			if (complete) {
+				twoBody.push_back(e);
+				forEachOrder(e, [&](const std::int32_t* sites) {
+					if (!vanishes(sites) || matches(two, sites, 4, 0.5 * e.value)) {
+						two.erase(siteKey(sites, 4));
+					}
+				});
+			}
+		}
+
+		index();
+
+		for (auto& t : one) {
+			residualOneBody.emplace_back(t.first, t.second.first);
+		}
+		for (auto& t : two) {
+			residualTwoBody.emplace_back(t.first, t.second.first);
+		}
+	}
+
+	/**
+	 * Build a store from spatial integrals given in any of their
+	 * equivalent index orders, as read from an FCIDUMP file. A
+	 * repeated integral replaces the earlier one.
+	 *
+	 * @param nSpatialOrbitals The number of spatial orbitals
+	 * @param nuclearEnergy The constant energy
+	 * @param h The one-electron integrals h(p,q)
+	 * @param g The two-electron integrals (pq|rs), keys are ignored
+	 */
+	IntegralStore(const int nSpatialOrbitals, const double nuclearEnergy,
+			const std::vector<OneBodyIntegral>& h,
+			const std::vector<TwoBodyIntegral>& g) :
+			nSpatial(nSpatialOrbitals), eNuc(nuclearEnergy) {
+		if (nSpatial > 0x8000) {
+			xacc::error("IntegralStore supports at most 32768 spatial orbitals.");
+		}
+
+		std::unordered_map<std::uint64_t, std::size_t> oneBodyIdx, twoBodyIdx;
+		for (auto& e : h) {
+			auto key = pairIndex(e.p, e.q);
+			auto it = oneBodyIdx.find(key);
+			if (it == oneBodyIdx.end()) {
+				oneBodyIdx.insert( { key, oneBody.size() });
+				oneBody.push_back( { std::max(e.p, e.q), std::min(e.p, e.q), e.value });
+			} else {
+				oneBody[it->second].value = e.value;
+			}
+		}
+		for (auto& e : g) {
+			auto c = canonical(e.p, e.q, e.r, e.s, e.value);
+			auto it = twoBodyIdx.find(c.key);
+			if (it == twoBodyIdx.end()) {
+				twoBodyIdx.insert( { c.key, twoBody.size() });
+				twoBody.push_back(c);
+			} else {
+				twoBody[it->second].value = c.value;
+			}
+		}
+		index();
+	}
+
+	/**
+	 * Append the spin-orbital terms of this Hamiltonian to op:
+	 * the nuclear energy, h(p,q) a_P^+ a_Q and (ps|qr) / 2
+	 * a_P^+ a_Q^+ a_R a_S over all spin-conserving index orders
+	 * equivalent to a stored integral. Terms that vanish by
+	 * symmetry are skipped, and the kept verbatim terms follow.
+	 *
+	 * @param op The operator to append to
+	 * @param tol The magnitude below which integrals are skipped
+	 */
+	void expand(FermionOperator& op, const double tol = 1e-12) const {
+		std::size_t nTerms = 0, nSites = 0;
+		forEachSpinOrbitalTerm(
+				[&](const std::int32_t*, const int n, const std::uint32_t,
+						const std::complex<double>) {
+					nTerms++;
+					nSites += n;
+				}, tol);
+		op.reserve(op.nTerms() + nTerms, op.nSites() + nSites);
+		forEachSpinOrbitalTerm(
+				[&](const std::int32_t* sites, const int n, const std::uint32_t mask,
+						const std::complex<double> c) {
+					op.addTerm(sites, n, mask, c);
+				}, tol);
+	}
+
+	/**
+	 * Return the number of spatial orbitals.
+	 */
+	int nSpatialOrbitals() const {
+		return nSpatial;
+	}
+
+	/**
+	 * Return the number of spatial orbital pairs p >= q,
+	 * which is also the number of two-body blocks.
+	 */
+	std::size_t nPairs() const {
+		return std::size_t(nSpatial) * (nSpatial + 1) / 2;
+	}
+
+	double nuclearEnergy() const {
+		return eNuc;
+	}
+
+	const std::vector<OneBodyIntegral>& getOneBodyIntegrals() const {
+		return oneBody;
+	}
+
+	const std::vector<TwoBodyIntegral>& getTwoBodyIntegrals() const {
+		return twoBody;
+	}
+
+	/**
+	 * Return the unique integrals (pq|rs) for the given pq,
+	 * in increasing rs <= pq.
+	 *
+	 * @param p The first spatial orbital
+	 * @param q The second spatial orbital
+	 * @return block The integrals
+	 */
+	Block block(const int p, const int q) const {
+		if (p < 0 || q < 0 || p >= nSpatial || q >= nSpatial) {
+			return Block(nullptr, nullptr);
+		}
+		auto b = pairIndex(p, q);
+		return Block(twoBody.data() + blockPtr[b],
+				twoBody.data() + blockPtr[b + 1]);
+	}
+
+	/**
+	 * Return the spatial one-electron integral h(p,q).
+	 */
+	double oneBodyIntegral(const int p, const int q) const {
+		auto key = pairIndex(p, q);
+		auto it = std::lower_bound(oneBody.begin(), oneBody.end(), key,
+				[](const OneBodyIntegral& a, const std::uint64_t k) {
+					return pairIndex(a.p, a.q) < k;
+				});
+		return it != oneBody.end() && pairIndex(it->p, it->q) == key ?
+				it->value : 0.0;
+	}
+
+	/**
+	 * Return the spatial two-electron integral (pq|rs).
+	 */
+	double twoBodyIntegral(const int p, const int q, const int r,
+			const int s) const {
+		auto pq = pairIndex(p, q), rs = pairIndex(r, s);
+		auto key = pairIndex(pq, rs);
+		auto b = block(pq >= rs ? p : r, pq >= rs ? q : s);
+		auto it = std::lower_bound(b.begin(), b.end(), key,
+				[](const TwoBodyIntegral& a, const std::uint64_t k) {
+					return a.key < k;
+				});
+		return it != b.end() && it->key == key ? it->value : 0.0;
+	}
+
+	/**
+	 * Return the coefficient of a_p^+ a_q over spin orbitals.
+	 */
+	std::complex<double> hpq(const int p, const int q) const {
+		if (!inRange(p) || !inRange(q)) {
+			return 0.0;
+		}
+		std::int32_t sites[2] = { p, q };
+		auto res = findResidual(residualOneBody, siteKey(sites, 2));
+		if (res) {
+			return *res;
+		}
+		return (p ^ q) & 1 ? 0.0 : oneBodyIntegral(p / 2, q / 2);
+	}
+
+	/**
+	 * Return the coefficient of a_p^+ a_q^+ a_r a_s
+	 * over spin orbitals.
+	 */
+	std::complex<double> hpqrs(const int p, const int q, const int r,
+			const int s) const {
+		if (!inRange(p) || !inRange(q) || !inRange(r) || !inRange(s)) {
+			return 0.0;
+		}
+		std::int32_t sites[4] = { p, q, r, s };
+		auto res = findResidual(residualTwoBody, siteKey(sites, 4));
+		if (res) {
+			return *res;
+		}
+		if (((p ^ s) & 1) || ((q ^ r) & 1)) {
+			return 0.0;
+		}
+		return 0.5 * twoBodyIntegral(p / 2, s / 2, q / 2, r / 2);
+	}
+
+	/**
+	 * Fill a dense n x n spin-orbital tensor of hpq.
+	 */
+	void fillOneBody(Eigen::Tensor<std::complex<double>, 2>& t, const int n) const {
+		t.setZero();
+		for (auto& e : oneBody) {
+			forEachOrder(e, [&](const std::int32_t* sites) {
+				if (sites[0] < n && sites[1] < n) {
+					t(sites[0], sites[1]) = e.value;
+				}
+			});
+		}
+		for (auto& r : residualOneBody) {
+			int p = r.first >> 16, q = r.first & 0xFFFF;
+			if (p < n && q < n) {
+				t(p, q) = r.second;
+			}
+		}
+	}
+
+	/**
+	 * Fill a dense n^4 spin-orbital tensor of hpqrs.
+	 */
+	void fillTwoBody(Eigen::Tensor<std::complex<double>, 4>& t, const int n) const {
+		t.setZero();
+		for (auto& e : twoBody) {
+			forEachOrder(e, [&](const std::int32_t* sites) {
+				if (sites[0] < n && sites[1] < n && sites[2] < n && sites[3] < n) {
+					t(sites[0], sites[1], sites[2], sites[3]) = 0.5 * e.value;
+				}
+			});
+		}
+		for (auto& res : residualTwoBody) {
+			int p = res.first >> 48, q = (res.first >> 32) & 0xFFFF;
+			int r = (res.first >> 16) & 0xFFFF, s = res.first & 0xFFFF;
+			if (p < n && q < n && r < n && s < n) {
+				t(p, q, r, s) = res.second;
+			}
+		}
+	}
+};
+
+/**
+ * A read-only spin-orbital view of the one-electron
+ * integrals in an IntegralStore.
+ */
+class OneBodyIntegrals {
+
+protected:
+
+	std::shared_ptr<const IntegralStore> store;
+
+	int n;
+
+public:
+
+	OneBodyIntegrals(std::shared_ptr<const IntegralStore> s,
+			const int nSpinOrbitals) :
+			store(s), n(nSpinOrbitals) {
+	}
+
+	int dimension() const {
+		return n;
+	}
+
+	std::complex<double> operator()(const int p, const int q) const {
+		return p < n && q < n ? store->hpq(p, q) : 0.0;
+	}
+
+	const IntegralStore& getStore() const {
+		return *store;
+	}
+
+	/**
+	 * Expand the view into a dense tensor.
+	 */
+	Eigen::Tensor<std::complex<double>, 2> toTensor() const {
+		Eigen::Tensor<std::complex<double>, 2> t(n, n);
+		store->fillOneBody(t, n);
+		return t;
+	}
+};
+
+/**
+ * A read-only spin-orbital view of the two-electron
+ * integrals in an IntegralStore.
+ */
+class TwoBodyIntegrals {
+
+protected:
+
+	std::shared_ptr<const IntegralStore> store;
+
+	int n;
+
+public:
+
+	TwoBodyIntegrals(std::shared_ptr<const IntegralStore> s,
+			const int nSpinOrbitals) :
+			store(s), n(nSpinOrbitals) {
+	}
+
+	int dimension() const {
+		return n;
+	}
+
+	std::complex<double> operator()(const int p, const int q, const int r,
+			const int s) const {
+		return p < n && q < n && r < n && s < n ?
+				store->hpqrs(p, q, r, s) : 0.0;
+	}
+
+	const IntegralStore& getStore() const {
+		return *store;
+	}
+
+	/**
+	 * Expand the view into a dense tensor. This needs n^4
+	 * complex entries, prefer the block API of the store.
+	 */
+	Eigen::Tensor<std::complex<double>, 4> toTensor() const {
+		Eigen::Tensor<std::complex<double>, 4> t(n, n, n, n);
+		store->fillTwoBody(t, n);
+		return t;
+	}
+};
+
+}
+
+}
+
+#endif
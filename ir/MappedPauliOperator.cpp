@@ -0,0 +1,257 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include "MappedPauliOperator.hpp"
+#include <fstream>
+#include <unordered_map>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xacc {
+namespace vqe {
+
+namespace {
+
+const char magic[8] = { 'X', 'V', 'Q', 'E', 'P', 'A', 'U', 'L' };
+const std::uint32_t byteOrderMark = 0x01020304;
+
+/**
+ * Memory-map the file at path, setting length to its size.
+ * Return null if it can not be opened or mapped.
+ */
+std::shared_ptr<const char> mapFile(const std::string& path,
+		std::size_t& length) {
+	auto fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return nullptr;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return nullptr;
+	}
+	length = st.st_size;
+
+	auto addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		return nullptr;
+	}
+	auto len = length;
+	return std::shared_ptr<const char>(static_cast<const char*>(addr),
+			[len](const char* p) {
+				munmap(const_cast<char*>(p), len);
+			});
+}
+
+template<typename T>
+void appendArray(std::string& out, const std::vector<T>& data) {
+	out.append(reinterpret_cast<const char*>(data.data()),
+			data.size() * sizeof(T));
+}
+
+}
+
+std::string PauliOperator::pack() const {
+	std::uint64_t nWords = 0;
+	for (auto& kv : terms) {
+		nWords = std::max<std::uint64_t>(nWords, kv.second.pauliString().nWords());
+	}
+
+	auto n = terms.size();
+	std::vector<std::uint64_t> xs(n * nWords), zs(n * nWords);
+	std::vector<std::complex<double>> coeffs(n);
+	std::vector<std::int64_t> varIds(n, -1);
+	std::vector<std::uint64_t> varOffsets { 0 };
+	std::string varNames;
+	std::unordered_map<std::string, std::int64_t> interned;
+
+	std::size_t i = 0;
+	for (auto& kv : terms) {
+		auto& t = kv.second;
+		auto& ps = t.pauliString();
+		for (std::uint64_t w = 0; w < nWords; w++) {
+			xs[i * nWords + w] = ps.x(w);
+			zs[i * nWords + w] = ps.z(w);
+		}
+		coeffs[i] = t.coeff();
+
+		auto& var = std::get<1>(t);
+		if (!var.empty()) {
+			auto it = interned.find(var);
+			if (it == interned.end()) {
+				it = interned.insert({var, varOffsets.size() - 1}).first;
+				varNames += var;
+				varOffsets.push_back(varNames.size());
+			}
+			varIds[i] = it->second;
+		}
+		i++;
+	}
+
+	PauliOperatorFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = MappedPauliOperator::Version;
+	header.byteOrder = byteOrderMark;
+	header.nTerms = n;
+	header.nWords = nWords;
+	header.nVariables = varOffsets.size() - 1;
+	header.varBytes = varNames.size();
+	header.flags = canonical ? MappedPauliOperator::Canonical : 0;
+
+	std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+	appendArray(data, xs);
+	appendArray(data, zs);
+	appendArray(data, coeffs);
+	appendArray(data, varIds);
+	appendArray(data, varOffsets);
+	data += varNames;
+	return data;
+}
+
+PauliOperator PauliOperator::unpack(const std::string& data) {
+	// The terms are copied out straight away, so the
+	// buffer need not outlive the view
+	std::shared_ptr<const char> buffer(data.data(), [](const char*) {});
+	return MappedPauliOperator(buffer, data.size(), "PauliOperator buffer").toPauliOperator();
+}
+
+void PauliOperator::save(const std::string& path) const {
+	auto data = pack();
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		xacc::error("Could not open " + path + " to save PauliOperator.");
+	}
+	out.write(data.data(), data.size());
+	if (!out) {
+		xacc::error("Failed writing PauliOperator to " + path + ".");
+	}
+}
+
+PauliOperator PauliOperator::load(const std::string& path) {
+	return MappedPauliOperator(path).toPauliOperator();
+}
+
+MappedPauliOperator::MappedPauliOperator(const std::string& path) {
+	mapping = mapFile(path, length);
+	if (!mapping) {
+		xacc::error("Could not open and map PauliOperator file " + path + ".");
+	}
+	attach(path);
+}
+
+MappedPauliOperator::MappedPauliOperator(std::shared_ptr<const char> data,
+		const std::size_t size, const std::string& source) :
+		mapping(data), length(size) {
+	attach(source);
+}
+
+std::string MappedPauliOperator::validate(const char* data,
+		const std::size_t size) {
+	if (size < sizeof(PauliOperatorFileHeader)) {
+		return " is not a PauliOperator file.";
+	}
+
+	auto h = reinterpret_cast<const PauliOperatorFileHeader*>(data);
+	if (std::memcmp(h->magic, magic, sizeof(magic)) != 0
+			|| h->byteOrder != byteOrderMark) {
+		return " is not a PauliOperator file for this platform.";
+	}
+	if (h->version != Version) {
+		return " has PauliOperator format version "
+				+ std::to_string(h->version) + ", expected "
+				+ std::to_string(Version) + ".";
+	}
+
+	// Compare section by section, so that huge counts in a
+	// corrupt header can not overflow the expected length
+	std::uint64_t available = size - sizeof(PauliOperatorFileHeader);
+	std::uint64_t nt = h->nTerms, nw = h->nWords;
+	if (nt > available / 24 || (nt && nw > (available / nt - 24) / 16)
+			|| h->nVariables > available / 8) {
+		return " is truncated.";
+	}
+	available -= 16 * nt * nw + 24 * nt;
+	if (8 * (h->nVariables + 1) > available
+			|| h->varBytes > available - 8 * (h->nVariables + 1)) {
+		return " is truncated.";
+	}
+	return "";
+}
+
+bool MappedPauliOperator::tryLoad(const std::string& path, PauliOperator& op) {
+	std::size_t length = 0;
+	auto mapping = mapFile(path, length);
+	if (!mapping || !validate(mapping.get(), length).empty()) {
+		return false;
+	}
+	op = MappedPauliOperator(mapping, length, path).toPauliOperator();
+	return true;
+}
+
+void MappedPauliOperator::attach(const std::string& source) {
+	auto problem = validate(mapping.get(), length);
+	if (!problem.empty()) {
+		xacc::error(source + problem);
+	}
+
+	header = reinterpret_cast<const PauliOperatorFileHeader*>(mapping.get());
+	auto nt = header->nTerms, nw = header->nWords;
+	auto p = mapping.get() + sizeof(PauliOperatorFileHeader);
+	xs = reinterpret_cast<const std::uint64_t*>(p);
+	zs = xs + nt * nw;
+	coeffs = reinterpret_cast<const std::complex<double>*>(zs + nt * nw);
+	varIds = reinterpret_cast<const std::int64_t*>(coeffs + nt);
+	varOffsets = reinterpret_cast<const std::uint64_t*>(varIds + nt);
+	varNames = reinterpret_cast<const char*>(varOffsets + header->nVariables + 1);
+}
+
+PauliOperator MappedPauliOperator::toPauliOperator() const {
+	std::vector<TermMap<Term>::value_type> entries;
+	entries.reserve(nTerms());
+	for (std::size_t i = 0; i < nTerms(); i++) {
+		auto t = term(i);
+		auto h = t.hash();
+		entries.emplace_back(h, std::move(t));
+	}
+
+	PauliOperator op;
+	op.terms = TermMap<Term>::fromEntries(std::move(entries));
+	op.canonical = isCanonical();
+	return op;
+}
+
+}
+}
@@ -0,0 +1,197 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_MAPPEDPAULIOPERATOR_HPP_
+#define VQE_IR_MAPPEDPAULIOPERATOR_HPP_
+
+#include "PauliOperator.hpp"
+#include <memory>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The header of the binary PauliOperator format written by
+ * PauliOperator::save(). It is followed by 8-byte aligned sections:
+ *
+ *   x masks      nTerms * nWords uint64
+ *   z masks      nTerms * nWords uint64
+ *   coefficients nTerms complex<double>
+ *   variables    nTerms int64, an index into the variable table or -1
+ *   var offsets  (nVariables + 1) uint64 into the name bytes
+ *   var names    varBytes chars, the interned variable names
+ *
+ * All values are stored in host byte order, which byteOrder records.
+ */
+struct PauliOperatorFileHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint64_t nTerms;
+	std::uint64_t nWords;
+	std::uint64_t nVariables;
+	std::uint64_t varBytes;
+	std::uint64_t flags;
+	std::uint64_t reserved;
+};
+
+/**
+ * The MappedPauliOperator memory-maps a file written by
+ * PauliOperator::save() and exposes its terms in place, so
+ * opening a compiled Hamiltonian costs no parsing and the
+ * pages are shared between every process that maps it.
+ */
+class MappedPauliOperator {
+
+public:
+
+	static const std::uint32_t Version = 1;
+
+	/**
+	 * Flag set when the terms were saved in canonical order.
+	 */
+	static const std::uint64_t Canonical = 1;
+
+protected:
+
+	std::shared_ptr<const char> mapping;
+	std::size_t length = 0;
+
+	const PauliOperatorFileHeader* header = nullptr;
+	const std::uint64_t* xs = nullptr;
+	const std::uint64_t* zs = nullptr;
+	const std::complex<double>* coeffs = nullptr;
+	const std::int64_t* varIds = nullptr;
+	const std::uint64_t* varOffsets = nullptr;
+	const char* varNames = nullptr;
+
+	/**
+	 * Check the header of the data in mapping and point the
+	 * section arrays into it.
+	 */
+	void attach(const std::string& source);
+
+public:
+
+	/**
+	 * Check that size bytes of data hold a complete operator in
+	 * this platform's format and version, without reporting.
+	 *
+	 * @return problem Empty if the data is valid, otherwise
+	 * what is wrong with it
+	 */
+	static std::string validate(const char* data, const std::size_t size);
+
+	/**
+	 * Map the given file and check it, returning false instead
+	 * of reporting an error if it can not be opened or is not a
+	 * valid operator file.
+	 *
+	 * @param path The file written by PauliOperator::save()
+	 * @param op The operator to load the terms into
+	 * @return loaded True if op was loaded
+	 */
+	static bool tryLoad(const std::string& path, PauliOperator& op);
+
+	/**
+	 * Map the given file, checking its header.
+	 *
+	 * @param path The file written by PauliOperator::save()
+	 */
+	MappedPauliOperator(const std::string& path);
+
+	/**
+	 * View packed operator data already in memory, as returned
+	 * by PauliOperator::pack(). The data must be 8-byte aligned.
+	 *
+	 * @param data The packed operator
+	 * @param size The number of bytes of data
+	 * @param source A name for data in error messages
+	 */
+	MappedPauliOperator(std::shared_ptr<const char> data,
+			const std::size_t size, const std::string& source);
+
+	std::size_t nTerms() const {
+		return header->nTerms;
+	}
+
+	/**
+	 * Return the number of 64-bit words in each term's masks.
+	 */
+	std::size_t nWords() const {
+		return header->nWords;
+	}
+
+	bool isCanonical() const {
+		return header->flags & Canonical;
+	}
+
+	const std::uint64_t* x(const std::size_t i) const {
+		return xs + i * header->nWords;
+	}
+
+	const std::uint64_t* z(const std::size_t i) const {
+		return zs + i * header->nWords;
+	}
+
+	const std::complex<double>& coeff(const std::size_t i) const {
+		return coeffs[i];
+	}
+
+	/**
+	 * Return the variable of term i, empty if it has none.
+	 */
+	std::string var(const std::size_t i) const {
+		auto v = varIds[i];
+		return v < 0 ? "" :
+				std::string(varNames + varOffsets[v],
+						varOffsets[v + 1] - varOffsets[v]);
+	}
+
+	PauliString pauliString(const std::size_t i) const {
+		return PauliString(x(i), z(i), header->nWords);
+	}
+
+	Term term(const std::size_t i) const {
+		return Term(coeff(i), var(i), pauliString(i));
+	}
+
+	/**
+	 * Build a PauliOperator holding these terms.
+	 */
+	PauliOperator toPauliOperator() const;
+};
+
+}
+
+}
+
+#endif
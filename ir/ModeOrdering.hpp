@@ -0,0 +1,376 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_MODEORDERING_HPP_
+#define VQE_IR_MODEORDERING_HPP_
+
+#include "FermionOperator.hpp"
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <boost/algorithm/string.hpp>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * ModeOrdering chooses the qubit each fermionic mode is placed on
+ * so that the Jordan-Wigner Z strings of an operator are short. A
+ * term's strings run between consecutive pairs of the sites it acts
+ * on an odd number of times, sorted by qubit, so its string length
+ * is the number of qubits strictly inside those pairs. Orderings are
+ * scored by the string lengths weighted by |coefficient|, or by the
+ * longest string.
+ *
+ * An ordering is a permutation where permutation[m] is the
+ * qubit of mode m.
+ */
+class ModeOrdering {
+
+public:
+
+	enum class Objective {
+		Total, Max
+	};
+
+protected:
+
+	int n;
+
+	/**
+	 * The distinct sets of odd sites, flattened, with the
+	 * summed |coefficient| of the terms sharing each.
+	 */
+	std::vector<std::uint32_t> offsets { 0 };
+	std::vector<int> siteArray;
+	std::vector<double> weights;
+
+	/**
+	 * The site sets each mode belongs to.
+	 */
+	std::vector<std::vector<std::size_t>> setsOf;
+
+	int length(const std::size_t s, const std::vector<int>& permutation) const {
+		int positions[FermionOperator::MaxOperators];
+		auto k = offsets[s + 1] - offsets[s];
+		for (std::size_t i = 0; i < k; i++) {
+			positions[i] = permutation[siteArray[offsets[s] + i]];
+		}
+		std::sort(positions, positions + k);
+		int l = 0;
+		for (std::size_t i = 1; i < k; i += 2) {
+			l += positions[i] - positions[i - 1] - 1;
+		}
+		return l;
+	}
+
+	/**
+	 * The weighted total string length and a histogram of the
+	 * string lengths, whose top bucket is the longest string.
+	 */
+	struct Score {
+		double total = 0.0;
+		std::vector<std::size_t> histogram;
+		int longest() const {
+			for (int l = histogram.size() - 1; l > 0; l--) {
+				if (histogram[l]) {
+					return l;
+				}
+			}
+			return 0;
+		}
+		bool better(const Score& other, const Objective objective) const {
+			if (objective == Objective::Max && longest() != other.longest()) {
+				return longest() < other.longest();
+			}
+			return total < other.total - 1e-12 * std::abs(other.total);
+		}
+	};
+
+	Score score(const std::vector<int>& permutation) const {
+		Score s;
+		s.histogram.assign(std::max(n, 1), 0);
+		for (std::size_t i = 0; i < weights.size(); i++) {
+			auto l = length(i, permutation);
+			s.total += weights[i] * l;
+			s.histogram[l]++;
+		}
+		return s;
+	}
+
+public:
+
+	/**
+	 * Collect the string structure of op over nModes modes.
+	 */
+	ModeOrdering(const FermionOperator& op, const int nModes) :
+			n(nModes), setsOf(nModes) {
+		std::map<std::vector<int>, double> sets;
+		std::vector<int> odd;
+		for (std::size_t z = 0; z < op.nTerms(); z++) {
+			odd.assign(op.sites(z), op.sites(z) + op.nOperators(z));
+			std::sort(odd.begin(), odd.end());
+			std::size_t kept = 0;
+			for (std::size_t i = 0; i < odd.size();) {
+				auto j = i;
+				while (j < odd.size() && odd[j] == odd[i]) {
+					j++;
+				}
+				if ((j - i) & 1) {
+					odd[kept++] = odd[i];
+				}
+				i = j;
+			}
+			odd.resize(kept);
+			if (kept > 1) {
+				sets[odd] += std::abs(op.coeff(z));
+			}
+		}
+
+		for (auto& s : sets) {
+			for (auto m : s.first) {
+				setsOf[m].push_back(weights.size());
+			}
+			siteArray.insert(siteArray.end(), s.first.begin(), s.first.end());
+			offsets.push_back(siteArray.size());
+			weights.push_back(s.second);
+		}
+	}
+
+	/**
+	 * Return the weighted total string length under permutation.
+	 */
+	double totalLength(const std::vector<int>& permutation) const {
+		return score(permutation).total;
+	}
+
+	/**
+	 * Return the longest string under permutation.
+	 */
+	int maxLength(const std::vector<int>& permutation) const {
+		return score(permutation).longest();
+	}
+
+	/**
+	 * Return the reverse Cuthill-McKee ordering of the graph
+	 * coupling the modes of each site set. Each component is
+	 * searched breadth first from a mode of least degree, visiting
+	 * neighbours by increasing degree and then decreasing coupling,
+	 * and the visit order is reversed.
+	 */
+	std::vector<int> cuthillMcKee() const {
+		std::vector<std::map<int, double>> coupling(n);
+		for (std::size_t s = 0; s < weights.size(); s++) {
+			for (auto i = offsets[s]; i < offsets[s + 1]; i++) {
+				for (auto j = offsets[s]; j < offsets[s + 1]; j++) {
+					if (i != j) {
+						coupling[siteArray[i]][siteArray[j]] += weights[s];
+					}
+				}
+			}
+		}
+
+		std::vector<int> order;
+		std::vector<bool> visited(n, false);
+		while (order.size() < n) {
+			int start = -1;
+			for (int m = 0; m < n; m++) {
+				if (!visited[m] && (start < 0
+						|| coupling[m].size() < coupling[start].size())) {
+					start = m;
+				}
+			}
+			std::queue<int> queue;
+			queue.push(start);
+			visited[start] = true;
+			while (!queue.empty()) {
+				auto m = queue.front();
+				queue.pop();
+				order.push_back(m);
+				std::vector<std::pair<int, double>> next;
+				for (auto& c : coupling[m]) {
+					if (!visited[c.first]) {
+						next.push_back(c);
+					}
+				}
+				std::sort(next.begin(), next.end(),
+						[&](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+							if (coupling[a.first].size() != coupling[b.first].size()) {
+								return coupling[a.first].size() < coupling[b.first].size();
+							}
+							return a.second > b.second;
+						});
+				for (auto& c : next) {
+					visited[c.first] = true;
+					queue.push(c.first);
+				}
+			}
+		}
+
+		std::vector<int> permutation(n);
+		for (int k = 0; k < n; k++) {
+			permutation[order[k]] = n - 1 - k;
+		}
+		return permutation;
+	}
+
+	/**
+	 * Improve permutation by swapping the qubits of pairs of
+	 * modes while that lowers the objective, rescoring only the
+	 * site sets of the two modes for each swap.
+	 *
+	 * @param permutation The ordering to start from
+	 * @param objective The objective to lower
+	 * @param maxSweeps The largest number of passes over all pairs
+	 * @return permutation The refined ordering
+	 */
+	std::vector<int> refine(std::vector<int> permutation,
+			const Objective objective, const int maxSweeps = 10) const {
+		auto current = score(permutation);
+		std::vector<int> lengths(weights.size());
+		for (std::size_t s = 0; s < weights.size(); s++) {
+			lengths[s] = length(s, permutation);
+		}
+
+		std::vector<std::size_t> affected;
+		std::vector<std::int64_t> marks(weights.size(), -1);
+		std::vector<int> trial;
+		for (int sweep = 0; sweep < maxSweeps; sweep++) {
+			bool improved = false;
+			for (int a = 0; a < n; a++) {
+				for (int b = a + 1; b < n; b++) {
+					affected.clear();
+					for (auto m : { a, b }) {
+						for (auto s : setsOf[m]) {
+							if (marks[s] != std::int64_t(a) * n + b) {
+								marks[s] = std::int64_t(a) * n + b;
+								affected.push_back(s);
+							}
+						}
+					}
+					if (affected.empty()) {
+						continue;
+					}
+
+					// Rescore in place, undoing the swap if it does not help
+					std::swap(permutation[a], permutation[b]);
+					auto previous = current.total;
+					auto previousLongest = objective == Objective::Max ?
+							current.longest() : 0;
+					trial.resize(affected.size());
+					for (std::size_t i = 0; i < affected.size(); i++) {
+						auto s = affected[i];
+						trial[i] = length(s, permutation);
+						current.total += weights[s] * (trial[i] - lengths[s]);
+						current.histogram[lengths[s]]--;
+						current.histogram[trial[i]]++;
+					}
+					auto longest = objective == Objective::Max ?
+							current.longest() : 0;
+					bool accept = longest != previousLongest ?
+							longest < previousLongest :
+							current.total < previous - 1e-12 * std::abs(previous);
+					if (accept) {
+						for (std::size_t i = 0; i < affected.size(); i++) {
+							lengths[affected[i]] = trial[i];
+						}
+						improved = true;
+					} else {
+						for (std::size_t i = 0; i < affected.size(); i++) {
+							current.histogram[trial[i]]--;
+							current.histogram[lengths[affected[i]]]++;
+						}
+						current.total = previous;
+						std::swap(permutation[a], permutation[b]);
+					}
+				}
+			}
+			if (!improved) {
+				break;
+			}
+		}
+		return permutation;
+	}
+
+	/**
+	 * Return the better of the identity and reverse Cuthill-McKee
+	 * orderings, refined by local search if requested.
+	 */
+	std::vector<int> optimize(const Objective objective, const bool localSearch) const {
+		std::vector<int> permutation(n);
+		for (int m = 0; m < n; m++) {
+			permutation[m] = m;
+		}
+		auto rcm = cuthillMcKee();
+		if (score(rcm).better(score(permutation), objective)) {
+			permutation = rcm;
+		}
+		return localSearch ? refine(permutation, objective) : permutation;
+	}
+
+	/**
+	 * Parse a list of comma separated qubits, checking that it is
+	 * a permutation unless check is false.
+	 */
+	static std::vector<int> parse(const std::string& str, const bool check = true) {
+		std::vector<std::string> split;
+		boost::split(split, str, boost::is_any_of(","));
+		std::vector<int> permutation;
+		for (auto& s : split) {
+			boost::trim(s);
+			if (!s.empty()) {
+				permutation.push_back(std::stoi(s));
+			}
+		}
+		auto sorted = permutation;
+		std::sort(sorted.begin(), sorted.end());
+		for (int i = 0; check && i < sorted.size(); i++) {
+			if (sorted[i] != i) {
+				xacc::error("Invalid mode permutation " + str);
+			}
+		}
+		return permutation;
+	}
+
+	static std::string toString(const std::vector<int>& permutation) {
+		std::string str;
+		for (auto q : permutation) {
+			str += (str.empty() ? "" : ",") + std::to_string(q);
+		}
+		return str;
+	}
+};
+
+}
+
+}
+
+#endif
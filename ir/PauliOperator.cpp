@@ -1,33 +1,164 @@
 #include "PauliOperator.hpp"
 #include "IRProvider.hpp"
 #include <boost/math/constants/constants.hpp>
+#include <thread>
 
 namespace xacc {
 namespace vqe {
-const std::map<std::string, std::pair<c, std::string>> Term:: pauliProducts =  Term::create_map();
+
+int PauliOperator::nThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+
+thread_local bool PauliOperator::serialThread = false;
+
+namespace {
+
+/**
+ * Run f(0), ..., f(n-1) on n threads, f(0) on the calling one.
+ * Every f holds a SerialScope, so it starts no threads of its own.
+ */
+template<typename F>
+void parallelFor(const int n, F f) {
+	if (n == 1) {
+		f(0);
+		return;
+	}
+	std::vector<std::thread> workers;
+	for (int t = 1; t < n; t++) {
+		workers.emplace_back([&f, t]() {
+			PauliOperator::SerialScope serial;
+			f(t);
+		});
+	}
+	{
+		PauliOperator::SerialScope serial;
+		f(0);
+	}
+	for (auto& w : workers) {
+		w.join();
+	}
+}
+
+/**
+ * Return the shard a term hash belongs to. The TermMap
+ * probes on the low bits, so shard on the high ones.
+ */
+int shardOf(const std::uint64_t h, const int nShards) {
+	return (h >> 32) % nShards;
+}
+
+/**
+ * Multiply a and b on nThreads threads. Thread t multiplies its
+ * contiguous block of a against all of b, accumulating into one
+ * partial map per shard of the product hash. Thread s then merges
+ * shard s of every partial in thread order, so the result only
+ * depends on the inputs and the thread count.
+ */
+TermMap<Term> parallelProduct(const TermMap<Term>& a, const TermMap<Term>& b,
+		const int nThreads, const double tol) {
+	std::vector<std::vector<TermMap<Term>>> partials(nThreads,
+			std::vector<TermMap<Term>>(nThreads));
+
+	parallelFor(nThreads, [&](const int t) {
+		auto& shards = partials[t];
+		auto first = a.begin() + a.size() * t / nThreads;
+		auto last = a.begin() + a.size() * (t + 1) / nThreads;
+		for (auto it = first; it != last; ++it) {
+			for (auto& vkv : b) {
+				Term multTerm = it->second;
+				multTerm *= vkv.second;
+				auto h = multTerm.hash();
+				shards[shardOf(h, nThreads)].accumulate(h, std::move(multTerm), tol);
+			}
+		}
+	});
+
+	std::vector<TermMap<Term>> merged(nThreads);
+	parallelFor(nThreads, [&](const int s) {
+		for (int t = 0; t < nThreads; t++) {
+			merged[s].merge(std::move(partials[t][s]), tol);
+		}
+	});
+
+	return TermMap<Term>::concat(merged);
+}
+
+/**
+ * Add the canonically ordered maps a and b with a single
+ * linear merge, keeping the result in canonical order.
+ */
+TermMap<Term> mergeSorted(const TermMap<Term>& a, const TermMap<Term>& b,
+		const double tol) {
+	std::vector<TermMap<Term>::value_type> merged;
+	merged.reserve(a.size() + b.size());
+
+	auto i = a.begin(), j = b.begin();
+	while (i != a.end() || j != b.end()) {
+		if (j == b.end() || (i != a.end() && Term::lessKey(i->second, j->second))) {
+			merged.push_back(*i++);
+		} else if (i == a.end() || Term::lessKey(j->second, i->second)) {
+			merged.push_back(*j++);
+		} else {
+			merged.push_back(*i++);
+			merged.back().second.coeff() += (j++)->second.coeff();
+		}
+
+		if (std::abs(merged.back().second.coeff()) < tol) {
+			merged.pop_back();
+		}
+	}
+
+	return TermMap<Term>::fromEntries(std::move(merged));
+}
+
+/**
+ * Add b to a on nThreads threads. Thread s builds shard s of the
+ * sum from the terms of a and then b that hash into it.
+ */
+TermMap<Term> parallelSum(const TermMap<Term>& a, const TermMap<Term>& b,
+		const int nThreads, const double tol) {
+	std::vector<TermMap<Term>> shards(nThreads);
+
+	parallelFor(nThreads, [&](const int s) {
+		auto& shard = shards[s];
+		shard.reserve((a.size() + b.size()) / nThreads);
+		for (auto& kv : a) {
+			if (shardOf(kv.first, nThreads) == s) {
+				shard.accumulate(kv.first, kv.second, tol);
+			}
+		}
+		for (auto& kv : b) {
+			if (shardOf(kv.first, nThreads) == s) {
+				shard.accumulate(kv.first, kv.second, tol);
+			}
+		}
+	});
+
+	return TermMap<Term>::concat(shards);
+}
+
+}
 
 PauliOperator::PauliOperator() {
 }
 
 PauliOperator::PauliOperator(std::complex<double> c) {
-	terms.emplace(std::make_pair("I",c));
+	terms.insert(Term(c));
 }
 
 PauliOperator::PauliOperator(double c) {
-	terms.emplace(std::make_pair("I",c));
+	terms.insert(Term(c));
 }
 
 PauliOperator::PauliOperator(std::string var) {
-	terms.emplace(std::make_pair("I", var));
+	terms.insert(Term(var));
 }
 
 PauliOperator::PauliOperator(std::complex<double> c, std::string var) {
-	terms.emplace(std::piecewise_construct,
-            std::forward_as_tuple("I"),
-            std::forward_as_tuple(c, var));
+	terms.insert(Term(c, var));
 }
 
-PauliOperator::PauliOperator(const PauliOperator& i) : terms(i.terms) {
+PauliOperator::PauliOperator(const PauliOperator& i) :
+		terms(i.terms), canonical(i.canonical) {
 }
 
 /**
@@ -37,13 +168,11 @@ PauliOperator::PauliOperator(const PauliOperator& i) : terms(i.terms) {
  * @param operators The pauli operators making up this SpinInstruction
  */
 PauliOperator::PauliOperator(std::map<int, std::string> operators) {
-	terms.emplace(std::make_pair(Term::id(operators), operators));
+	terms.insert(Term(operators));
 }
 
 PauliOperator::PauliOperator(std::map<int, std::string> operators, std::string var) {
-	terms.emplace(std::piecewise_construct,
-            std::forward_as_tuple(Term::id(operators, var)),
-            std::forward_as_tuple(var, operators));
+	terms.insert(Term(var, operators));
 }
 
 /**
@@ -55,10 +184,7 @@ PauliOperator::PauliOperator(std::map<int, std::string> operators, std::string v
  */
 PauliOperator::PauliOperator(std::map<int, std::string> operators,
 		std::complex<double> coeff) {
-	terms.emplace(std::piecewise_construct,
-            std::forward_as_tuple(Term::id(operators)),
-            std::forward_as_tuple(coeff, operators));
-
+	terms.insert(Term(coeff, operators));
 }
 
 PauliOperator::PauliOperator(std::map<int, std::string> operators,
@@ -67,70 +193,71 @@ PauliOperator::PauliOperator(std::map<int, std::string> operators,
 
 PauliOperator::PauliOperator(std::map<int, std::string> operators,
 		std::complex<double> coeff, std::string var) {
-	terms.emplace(std::piecewise_construct,
-            std::forward_as_tuple(Term::id(operators, var)),
-            std::forward_as_tuple(coeff, var, operators));
-
+	terms.insert(Term(coeff, var, operators));
 }
 
-std::vector<Triplet> PauliOperator::getSparseMatrixElements() {
+namespace {
 
-	// Get number of qubits
-	std::set<int> distinctSites;
-	for (auto& kv : terms) {
-		for (auto& kv2 : kv.second.ops()) {
-			distinctSites.insert(kv2.first);
+/**
+ * Pack a bitstring, where character q is the state of qubit q,
+ * into 64-bit words.
+ */
+std::vector<std::uint64_t> packBits(const std::string& bitString) {
+	std::vector<std::uint64_t> words((bitString.size() + 63) / 64, 0);
+	for (std::size_t q = 0; q < bitString.size(); q++) {
+		if (bitString[q] == '1') {
+			words[q >> 6] |= std::uint64_t(1) << (q & 63);
 		}
 	}
+	return words;
+}
 
-	auto nQubits = distinctSites.size();
-
-	std::vector<Triplet> triplets;
-
-	for (auto& kv : terms) {
-		auto termTrips = kv.second.getSparseMatrixElements(nQubits);
-		triplets.insert(std::end(triplets), std::begin(termTrips), std::end(termTrips));
+/**
+ * Apply the Pauli string to the packed basis state, returning
+ * the resultant bitstring and coefficient.
+ *
+ * With Y = iXZ, P|b> = i^nY (-1)^popcount(z & b) |b ^ x>, and
+ * the action on a bra picks up (-i)^nY instead.
+ */
+ActionResult applyPacked(const PauliString& ops, std::complex<double> coeff,
+		const std::string& bitString, const std::vector<std::uint64_t>& bits,
+		ActionType type) {
+	int sign = 0;
+	for (std::uint32_t w = 0; w < ops.nWords() && w < bits.size(); w++) {
+		sign += __builtin_popcountll(ops.z(w) & bits[w]);
 	}
 
-	return triplets;
-}
+	// Phase is i^k
+	int k = 2 * (sign & 1) + (type == ActionType::Ket ? 1 : 3) * ops.nY();
+	static const std::complex<double> phases[] = { { 1, 0 }, { 0, 1 },
+			{ -1, 0 }, { 0, -1 } };
 
-ActionResult Term::action(const std::string& bitString, ActionType type) {
-
-	auto _coeff = coeff();
 	auto newBits = bitString;
-	c i(0,1);
-
-	for (auto& t : ops()) {
-		auto idx = t.first;
-		auto gate = t.second;
-
-		if (gate == "Z") {
-			_coeff *= newBits[idx] == '1' ? -1 : 1;
-		} else if (gate == "X") {
-			newBits[idx] = (newBits[idx] == '1' ? '0' : '1');
-		} else if (gate == "Y") {
-			if (type == ActionType::Bra) {
-				_coeff *= newBits[idx] == '1' ? i : -i;
-			} else {
-				_coeff *= newBits[idx] == '1' ? -i : i;
-			}
-			newBits[idx] = (newBits[idx] == '1' ? '0' : '1');
+	ops.forEachOp([&](const int q, const char op) {
+		if (op != 'Z') {
+			newBits[q] = (newBits[q] == '1' ? '0' : '1');
 		}
-	}
+	});
+
+	return {newBits, coeff * phases[k & 3]};
+}
+
+}
 
-	return {newBits, _coeff};
+ActionResult Term::action(const std::string& bitString, ActionType type) {
+	return applyPacked(pauliString(), coeff(), bitString, packBits(bitString), type);
 }
 
 const std::vector<std::pair<std::string, std::complex<double>>> PauliOperator::computeActionOnKet(
 		const std::string& bitString) {
 
 	std::vector<std::pair<std::string, std::complex<double>>> ret;
-	std::string newBits = bitString;
-	std::complex<double> newCoeff(1,0), i(0,1);
+	auto bits = packBits(bitString);
 
 	for (auto& kv : terms) {
-		ret.push_back(kv.second.action(bitString, ActionType::Ket));
+		ret.push_back(
+				applyPacked(kv.second.pauliString(), kv.second.coeff(),
+						bitString, bits, ActionType::Ket));
 	}
 	return ret;
 }
@@ -138,27 +265,374 @@ const std::vector<std::pair<std::string, std::complex<double>>> PauliOperator::c
 const std::vector<std::pair<std::string, std::complex<double>>> PauliOperator::computeActionOnBra(
 		const std::string& bitString) {
 	std::vector<std::pair<std::string, std::complex<double>>> ret;
+	auto bits = packBits(bitString);
 
 	for (auto& kv : terms) {
-		ret.push_back(kv.second.action(bitString, ActionType::Bra));
+		ret.push_back(
+				applyPacked(kv.second.pauliString(), kv.second.coeff(),
+						bitString, bits, ActionType::Bra));
 	}
 
 	return ret;
 }
 
+namespace {
+
+/**
+ * Return i^k for the phase of a Pauli string acting on a basis
+ * state with popcount(z & b) = sign. Kets pick up i^nY and
+ * bras (-i)^nY.
+ */
+std::complex<double> basisPhase(const int sign, const int nY,
+		const ActionType type) {
+	static const std::complex<double> phases[] = { { 1, 0 }, { 0, 1 },
+			{ -1, 0 }, { 0, -1 } };
+	return phases[(2 * (sign & 1) + (type == ActionType::Ket ? 1 : 3) * nY) & 3];
+}
+
+void applyToIndex(const TermMap<Term>& terms, const std::uint64_t b,
+		std::vector<BasisAction>& result, const ActionType type) {
+	result.resize(terms.size());
+	auto out = result.data();
+	for (auto& kv : terms) {
+		auto& ops = kv.second.pauliString();
+		if (ops.nWords() > 1 && ops.maxQubit() >= 64) {
+			xacc::error("Integer basis actions require terms on qubits below 64, "
+					"use the multi-word computeAction instead.");
+		}
+		auto x = ops.x(0), z = ops.z(0);
+		out->first = b ^ x;
+		out->second = kv.second.coeff()
+				* basisPhase(__builtin_popcountll(z & b),
+						__builtin_popcountll(x & z), type);
+		out++;
+	}
+}
+
+void applyToWords(const TermMap<Term>& terms,
+		const std::vector<std::uint64_t>& b, std::vector<std::uint64_t>& states,
+		std::vector<std::complex<double>>& coeffs, const ActionType type) {
+	auto nw = b.size();
+	states.resize(terms.size() * nw);
+	coeffs.resize(terms.size());
+	auto outState = states.data();
+	auto outCoeff = coeffs.data();
+	for (auto& kv : terms) {
+		auto& ops = kv.second.pauliString();
+		if (ops.maxQubit() >= int(64 * nw)) {
+			xacc::error("Basis state has fewer qubits than the operator acts on.");
+		}
+		int sign = 0;
+		for (std::size_t w = 0; w < nw; w++) {
+			sign += __builtin_popcountll(ops.z(w) & b[w]);
+			outState[w] = b[w] ^ ops.x(w);
+		}
+		*outCoeff++ = kv.second.coeff() * basisPhase(sign, ops.nY(), type);
+		outState += nw;
+	}
+}
+
+}
+
+void PauliOperator::computeActionOnKet(const std::uint64_t ket,
+		std::vector<BasisAction>& result) const {
+	applyToIndex(terms, ket, result, ActionType::Ket);
+}
+
+void PauliOperator::computeActionOnBra(const std::uint64_t bra,
+		std::vector<BasisAction>& result) const {
+	applyToIndex(terms, bra, result, ActionType::Bra);
+}
+
+void PauliOperator::computeActionOnKet(const std::vector<std::uint64_t>& ket,
+		std::vector<std::uint64_t>& states,
+		std::vector<std::complex<double>>& coeffs) const {
+	applyToWords(terms, ket, states, coeffs, ActionType::Ket);
+}
+
+void PauliOperator::computeActionOnBra(const std::vector<std::uint64_t>& bra,
+		std::vector<std::uint64_t>& states,
+		std::vector<std::complex<double>>& coeffs) const {
+	applyToWords(terms, bra, states, coeffs, ActionType::Bra);
+}
+
+namespace {
+
+/**
+ * A term reduced to its masks, with c = coeff * (-i)^nY so that
+ * <j|term|j^x> = (-1)^popcount(z & j) * c.
+ */
+struct MaskedTerm {
+	std::uint64_t x;
+	std::uint64_t z;
+	double re;
+	double im;
+};
+
+std::vector<MaskedTerm> maskTerms(const TermMap<Term>& terms,
+		const int nQubits) {
+	if (nQubits < 0 || nQubits > 62) {
+		xacc::error("Cannot apply an operator to a state of "
+				+ std::to_string(nQubits) + " qubits.");
+	}
+
+	std::vector<MaskedTerm> masked;
+	masked.reserve(terms.size());
+	for (auto& kv : terms) {
+		auto& t = kv.second;
+		if (!std::get<1>(t).empty()) {
+			xacc::error("Cannot apply an operator with variable coefficients, "
+					"evaluate it first.");
+		}
+		auto& ops = t.pauliString();
+		if (ops.maxQubit() >= nQubits) {
+			xacc::error("Operator acts on qubit " + std::to_string(ops.maxQubit())
+					+ " of a " + std::to_string(nQubits) + " qubit state.");
+		}
+		auto c = t.coeff() * basisPhase(0, ops.nY(), ActionType::Bra);
+		masked.push_back({ops.x(0), ops.z(0), std::real(c), std::imag(c)});
+	}
+
+	// Terms sharing an x mask read the same input amplitudes
+	std::sort(masked.begin(), masked.end(),
+			[](const MaskedTerm& a, const MaskedTerm& b) {
+				return a.x < b.x;
+			});
+	return masked;
+}
+
+/**
+ * Add the contribution of term t to amplitudes [first, last) of out.
+ * Written with real arithmetic and a branch-free sign so the loop
+ * vectorizes.
+ */
+void applyTerm(const MaskedTerm& t, const std::complex<double>* in,
+		std::complex<double>* out, const std::uint64_t first,
+		const std::uint64_t last) {
+	auto src = reinterpret_cast<const double*>(in);
+	auto dst = reinterpret_cast<double*>(out);
+	for (std::uint64_t j = first; j < last; j++) {
+		double sign = 1.0 - 2.0 * __builtin_parityll(t.z & j);
+		auto k = j ^ t.x;
+		double a = src[2 * k], b = src[2 * k + 1];
+		dst[2 * j] += sign * (t.re * a - t.im * b);
+		dst[2 * j + 1] += sign * (t.re * b + t.im * a);
+	}
+}
+
+}
+
+void PauliOperator::apply(const std::complex<double>* in,
+		std::complex<double>* out, const int nQubits) const {
+	apply(in, out, nQubits, 1);
+}
+
+void PauliOperator::apply(const std::complex<double>* in,
+		std::complex<double>* out, const int nQubits, const int nVectors) const {
+	auto masked = maskTerms(terms, nQubits);
+	const std::uint64_t dim = std::uint64_t(1) << nQubits;
+
+	// Each thread owns a contiguous range of rows, which it sweeps in
+	// blocks small enough that out stays in cache across all terms
+	const std::uint64_t blockSize = 1 << 12;
+	auto n = dim < 2 * blockSize ? 1 : std::min<std::uint64_t>(threadsHere(), dim / blockSize);
+	parallelFor(n, [&](const int t) {
+		auto first = dim * t / n, last = dim * (t + 1) / n;
+		for (int v = 0; v < nVectors; v++) {
+			std::fill(out + v * dim + first, out + v * dim + last, 0.0);
+		}
+		for (auto b = first; b < last; b += blockSize) {
+			auto e = std::min(b + blockSize, last);
+			for (auto& term : masked) {
+				for (int v = 0; v < nVectors; v++) {
+					applyTerm(term, in + v * dim, out + v * dim, b, e);
+				}
+			}
+		}
+	});
+}
+
+namespace {
+
+/**
+ * Call f(column, value) for each nonzero in row j, where groups
+ * delimits the runs of masked terms sharing an x mask.
+ */
+template<typename ColIndex, typename F>
+void forEachRowElement(const std::vector<MaskedTerm>& masked,
+		const std::vector<std::size_t>& groups, const std::uint64_t j,
+		ColIndex& colIndex, F f) {
+	for (std::size_t g = 0; g + 1 < groups.size(); g++) {
+		auto col = colIndex(j ^ masked[groups[g]].x);
+		if (col < 0) {
+			continue;
+		}
+		double re = 0.0, im = 0.0;
+		for (auto t = groups[g]; t < groups[g + 1]; t++) {
+			double sign = 1.0 - 2.0 * __builtin_parityll(masked[t].z & j);
+			re += sign * masked[t].re;
+			im += sign * masked[t].im;
+		}
+		if (std::abs(std::complex<double>(re, im)) >= 1e-12) {
+			f(col, std::complex<double>(re, im));
+		}
+	}
+}
+
+/**
+ * Build a CSR matrix with nRows rows, row i being basis state
+ * rowState(i), keeping the columns for which colIndex returns a
+ * nonnegative index. Terms with the same x mask reach the same
+ * column, so each group is summed into a single element.
+ */
+template<typename RowState, typename ColIndex>
+CSRMatrix buildCSR(const std::vector<MaskedTerm>& masked,
+		const std::uint64_t nRows, const std::uint64_t nCols,
+		RowState rowState, ColIndex colIndex, const int nThreads) {
+	std::vector<std::size_t> groups;
+	for (std::size_t t = 0; t < masked.size(); t++) {
+		if (t == 0 || masked[t].x != masked[t - 1].x) {
+			groups.push_back(t);
+		}
+	}
+	groups.push_back(masked.size());
+
+	CSRMatrix csr;
+	csr.nRows = nRows;
+	csr.nCols = nCols;
+	csr.rowPtr.assign(nRows + 1, 0);
+
+	auto n = nRows < 4096 ? 1 : std::min<std::uint64_t>(nThreads, nRows / 2048);
+	parallelFor(n, [&](const int t) {
+		for (auto i = nRows * t / n; i < nRows * (t + 1) / n; i++) {
+			forEachRowElement(masked, groups, rowState(i), colIndex,
+					[&](const std::int64_t, const std::complex<double>&) {
+				csr.rowPtr[i + 1]++;
+			});
+		}
+	});
+
+	for (std::uint64_t i = 0; i < nRows; i++) {
+		csr.rowPtr[i + 1] += csr.rowPtr[i];
+	}
+	csr.colIdx.resize(csr.rowPtr[nRows]);
+	csr.values.resize(csr.rowPtr[nRows]);
+
+	parallelFor(n, [&](const int t) {
+		std::vector<std::pair<std::int64_t, std::complex<double>>> row;
+		for (auto i = nRows * t / n; i < nRows * (t + 1) / n; i++) {
+			row.clear();
+			forEachRowElement(masked, groups, rowState(i), colIndex,
+					[&](const std::int64_t col, const std::complex<double>& v) {
+				row.emplace_back(col, v);
+			});
+			std::sort(row.begin(), row.end(),
+					[](const std::pair<std::int64_t, std::complex<double>>& a,
+							const std::pair<std::int64_t, std::complex<double>>& b) {
+						return a.first < b.first;
+					});
+			auto k = csr.rowPtr[i];
+			for (auto& e : row) {
+				csr.colIdx[k] = e.first;
+				csr.values[k++] = e.second;
+			}
+		}
+	});
+
+	return csr;
+}
+
+SparseMatrix toSparseMatrix(const CSRMatrix& csr) {
+	return Eigen::Map<const SparseMatrix>(csr.nRows, csr.nCols,
+			csr.values.size(), csr.rowPtr.data(), csr.colIdx.data(),
+			csr.values.data());
+}
+
+}
+
+CSRMatrix PauliOperator::getCSRMatrix(const int nQubits) const {
+	auto masked = maskTerms(terms, nQubits);
+	const std::uint64_t dim = std::uint64_t(1) << nQubits;
+	return buildCSR(masked, dim, dim, [](const std::uint64_t i) {
+		return i;
+	}, [](const std::uint64_t b) {
+		return std::int64_t(b);
+	}, threadsHere());
+}
+
+CSRMatrix PauliOperator::getCSRMatrix(
+		const std::vector<std::uint64_t>& basis) const {
+	auto masked = maskTerms(terms, 62);
+	std::unordered_map<std::uint64_t, std::int64_t> index;
+	index.reserve(basis.size());
+	for (std::size_t i = 0; i < basis.size(); i++) {
+		index.insert({basis[i], i});
+	}
+	return buildCSR(masked, basis.size(), basis.size(),
+			[&](const std::uint64_t i) {
+				return basis[i];
+			}, [&](const std::uint64_t b) -> std::int64_t {
+				auto it = index.find(b);
+				return it == index.end() ? -1 : it->second;
+			}, threadsHere());
+}
+
+SparseMatrix PauliOperator::getSparseMatrix(const int nQubits) const {
+	return toSparseMatrix(getCSRMatrix(nQubits));
+}
+
+SparseMatrix PauliOperator::getSparseMatrix(
+		const std::vector<std::uint64_t>& basis) const {
+	return toSparseMatrix(getCSRMatrix(basis));
+}
+
+std::vector<Triplet> PauliOperator::getSparseMatrixElements() const {
+	int nQubits = 1;
+	for (auto& kv : terms) {
+		nQubits = std::max(nQubits, kv.second.pauliString().maxQubit() + 1);
+	}
+	return getSparseMatrixElements(nQubits);
+}
+
+std::vector<Triplet> PauliOperator::getSparseMatrixElements(
+		const int nQubits) const {
+	auto csr = getCSRMatrix(nQubits);
+	std::vector<Triplet> triplets;
+	triplets.reserve(csr.values.size());
+	for (std::uint64_t i = 0; i < csr.nRows; i++) {
+		for (auto k = csr.rowPtr[i]; k < csr.rowPtr[i + 1]; k++) {
+			triplets.emplace_back(i, csr.colIdx[k], csr.values[k]);
+		}
+	}
+	return triplets;
+}
+
 const int PauliOperator::nTerms() {
 	return terms.size();
 }
 
 bool PauliOperator::isClose(PauliOperator& other) {
-	if (!operator==(other)) {
+	if (terms.size() != other.terms.size()) {
 		return false;
 	}
 
-	// These are equal, check their coeffs
+	if (canonical && other.canonical) {
+		// Both are sorted, so compare them term by term
+		auto it = other.terms.begin();
+		for (auto& kv : terms) {
+			if (!(kv.second == it->second)
+					|| std::abs(kv.second.coeff() - it->second.coeff()) > 1e-6) {
+				return false;
+			}
+			++it;
+		}
+		return true;
+	}
+
 	for (auto& kv : terms) {
-		Term otherTerm = other.terms[kv.first];
-		if (std::abs(kv.second.coeff() - otherTerm.coeff()) > 1e-6) {
+		auto otherTerm = other.terms.find(kv.second);
+		if (otherTerm == other.terms.end()
+				|| std::abs(kv.second.coeff() - otherTerm->second.coeff()) > 1e-6) {
 			return false;
 		}
 	}
@@ -166,6 +640,14 @@ bool PauliOperator::isClose(PauliOperator& other) {
 	return true;
 }
 
+PauliOperator& PauliOperator::canonicalize() {
+	if (!canonical) {
+		terms.sort(Term::lessKey);
+		canonical = true;
+	}
+	return *this;
+}
+
 /**
  * Persist this Instruction to an assembly-like
  * string.
@@ -177,21 +659,16 @@ const std::string PauliOperator::toString() {
 	std::stringstream s;
 	for (auto& kv : terms) {
 		std::complex<double> c = std::get<0>(kv.second);
-		std::string v = std::get<1>(kv.second);
-		std::map<int, std::string> ops = std::get<2>(kv.second);
+		const std::string& v = std::get<1>(kv.second);
 
 		s << c << " ";
 		if (!v.empty()) {
 			s << v << " ";
 		}
 
-		for (auto& kv2 : ops) {
-			if (kv2.second == "I") {
-				s << "I ";
-			} else {
-				s << kv2.second << kv2.first << " ";
-			}
-		}
+		kv.second.pauliString().forEachOp([&](const int q, const char op) {
+			s << op << q << " ";
+		});
 
 		s << "+ ";
 	}
@@ -203,74 +680,100 @@ const std::string PauliOperator::toString() {
 
 void PauliOperator::clear() {
 	terms.clear();
+	canonical = false;
 }
 
 PauliOperator& PauliOperator::operator+=( const PauliOperator& v ) noexcept {
-	for (auto& kv : v.terms) {
+	if (canonical && v.canonical) {
+		terms = mergeSorted(terms, v.terms, 1e-12);
+		return *this;
+	}
+	canonical = false;
+
+	// Every thread of the sharded sum scans both operators, so it
+	// only pays off when the addend is large and dominates the sum
+	auto n = threadsHere();
+	if (n > 1 && v.terms.size() > (1 << 16) && v.terms.size() >= terms.size()) {
+		terms = parallelSum(terms, v.terms, n, 1e-12);
+		return *this;
+	}
 
-		auto termId = kv.first;
-		auto otherTerm = kv.second;
+	for (auto& kv : v.terms) {
+		terms.accumulate(kv.second, 1e-12);
+	}
 
-		if (terms.count(termId)) {
-			terms.at(termId).coeff() += otherTerm.coeff();
-		} else {
-			terms.insert({termId, otherTerm});
-		}
+	return *this;
+}
 
-		if (std::abs(terms[termId].coeff()) < 1e-12) {
-			terms.erase(termId);
+PauliOperator& PauliOperator::addProduct(const std::complex<double> coeff,
+		const std::vector<std::reference_wrapper<const PauliOperator>>& factors) {
+	canonical = false;
+
+	for (auto& f : factors) {
+		if (&f.get() == this) {
+			// Expanding into one of our own factors would
+			// invalidate it, so expand into a copy instead
+			PauliOperator copy(*this);
+			copy.addProduct(coeff, factors);
+			terms = std::move(copy.terms);
+			return *this;
 		}
 	}
 
+	std::vector<Term> partial(factors.size() + 1);
+	partial[0] = Term(coeff);
+	addProduct(factors, partial, 0);
 	return *this;
 }
 
+void PauliOperator::addProduct(
+		const std::vector<std::reference_wrapper<const PauliOperator>>& factors,
+		std::vector<Term>& partial, const std::size_t depth) {
+	if (depth == factors.size()) {
+		terms.accumulate(partial[depth], 1e-12);
+		return;
+	}
+
+	for (auto& kv : factors[depth].get().terms) {
+		partial[depth + 1] = partial[depth];
+		partial[depth + 1] *= kv.second;
+		addProduct(factors, partial, depth + 1);
+	}
+}
+
 PauliOperator& PauliOperator::operator-=( const PauliOperator& v ) noexcept {
 	return operator+=(-1.0 * v);
 }
 
 PauliOperator& PauliOperator::operator*=( const PauliOperator& v ) noexcept {
+	canonical = false;
 
-	std::unordered_map<std::string, Term> newTerms;
-	for (auto& kv : terms) {
-		for (auto& vkv : v.terms) {
-			auto multTerm = kv.second * vkv.second;
-			auto id = multTerm.id();
-
-			if (!newTerms.insert({id, multTerm}).second) {
-				newTerms.at(id).coeff() += multTerm.coeff();
-			}
-
-			if (std::abs(newTerms.at(id).coeff()) < 1e-12) {
-				newTerms.erase(id);
-			}
-		}
+	if (threadsHere() > 1 && terms.size() > 1
+			&& terms.size() * v.terms.size() > (1 << 14)) {
+		auto n = std::min<std::size_t>(threadsHere(), terms.size());
+		terms = parallelProduct(terms, v.terms, n, 1e-12);
+		return *this;
 	}
-	terms = newTerms;
-	return *this;
-}
 
-bool PauliOperator::operator==( const PauliOperator& v ) noexcept {
-	if (terms.size() != v.terms.size()) {
-		return false;
-	}
+	// The product has at most nTerms * v.nTerms terms, but
+	// cap the initial table size and let it grow past that
+	TermMap<Term> newTerms;
+	newTerms.reserve(
+			std::min(terms.size() * v.terms.size(), std::size_t(1) << 16));
 
 	for (auto& kv : terms) {
-		bool found = false;
 		for (auto& vkv : v.terms) {
-
-			if (kv.second.operator==(vkv.second)) {
-				found = true;
-				break;
-			}
-		}
-
-		if (!found) {
-			return false;
+			Term multTerm = kv.second;
+			multTerm *= vkv.second;
+			newTerms.accumulate(std::move(multTerm), 1e-12);
 		}
 	}
+	terms = std::move(newTerms);
+	return *this;
+}
 
-	return true;
+bool PauliOperator::operator==( const PauliOperator& v ) noexcept {
+	return ::operator==(*this, v);
 }
 
 PauliOperator& PauliOperator::operator*=( const double v ) noexcept {
@@ -284,107 +787,30 @@ PauliOperator& PauliOperator::operator*=( const std::complex<double> v ) noexcep
 	return *this;
 }
 
-std::vector<Triplet> Term::getSparseMatrixElements(const int nQubits) {
-
-	// X = |1><0| + |0><1|
-	// Y = -i|1><0| + i|0><1|
-	// Z = |0><0| - |1><1|
-
-	auto comb = [](int N, int K) -> std::vector<std::vector<int>>
-	{
-		std::string bitmask(K, 1); // K leading 1's
-			bitmask.resize(N, 0);// N-K trailing 0's
-
-			std::vector<std::vector<int>> allCombinations;
-			// print integers and permute bitmask
-			do {
-				std::vector<int> bits;
-				for (int i = 0; i < N; ++i) {
-					if (bitmask[i]) {
-						bits.push_back(i);
-					}
-
-//					if (bitmask[i]) std::cout << " " << i;
-				}
-
-				bool add = true;
-				for (int i = 1; i < bits.size(); i++) {
-					if(bits[i] % 2 != 0 && std::abs(bits[i] - bits[i-1]) == 1) {
-						add = false;
-						break;
-					}
-				}
-
-				if (add) {
-					allCombinations.push_back(bits);
-				}
-			}while (std::prev_permutation(bitmask.begin(), bitmask.end()));
-
-			for (auto a : allCombinations) {
-				for (auto b : a) {
-					std::cout << b << " ";
-				}
-				std::cout << "\n";
-			}
-
-			std::cout << (3/2) << "\n";
-			return allCombinations;
-		};
-
-	auto nSites = ops().size();
-	auto termCombinations = comb(2*nSites,nSites);
-
-	std::map<std::string, std::vector<std::pair<int, int>>> subterms;
-	subterms["X"] = {{1,0}, {0,1}};
-	subterms["Y"] = {{1,0}, {0,1}};
-	subterms["Z"] = {{0,0}, {1,1}};
-
-	std::string zeroStr = "";
-	for (int i = 0; i < nQubits; i++) zeroStr += "0";
+PauliOperator PauliOperator::hermitianConjugate() const {
+	PauliOperator adjoint(*this);
+	for (auto& kv : adjoint.terms) {
+		std::get<0>(kv.second) = std::conj(std::get<0>(kv.second));
+	}
+	return adjoint;
+}
 
-	auto ket = zeroStr;
-	auto bra = zeroStr;
+std::vector<Triplet> Term::getSparseMatrixElements(const int nQubits) const {
+	TermMap<Term> single;
+	single.insert(*this);
+	auto masked = maskTerms(single, nQubits);
 
 	std::vector<Triplet> triplets;
-	for (auto& combo : termCombinations) {
-
-		std::complex<double> coeff(1,0), i(0,1);
-		for (auto& c : combo) {
-
-			auto iter = ops().begin();
-			std::advance(iter, c/2);
-			auto ithOp = iter->second;
-			auto ithOpSite = iter->first;
-			auto x = (c % 2);
-
-//			Now I know the Operator and whether this is hte 0 or 1st term for that op
-
-			auto term = subterms[ithOp][x];
-
-			ket[ithOpSite] = term.first ? '1' : '0';
-			bra[ithOpSite] = term.second ? '1' : '0';
-
-			if (ithOp == "Y") {
-				if (x) {
-					coeff *= i;
-				} else {
-					coeff *= -i;
-				}
-			} else if (ithOp == "Z") {
-				if (x) {
-					coeff *= -1;
-				}
-			}
-		}
-
-		std::cout << "HEY WORLD: " << bra << ", " << ket << "\n";
-		// now convert bra and ket into integers
-		auto row = std::stol(bra, nullptr, 2);
-		auto col = std::stol(ket, nullptr, 2);
-
-		triplets.emplace_back(row, col, coeff);
+	if (masked.empty()) {
+		return triplets;
+	}
+	auto& t = masked[0];
+	const std::uint64_t dim = std::uint64_t(1) << nQubits;
+	triplets.reserve(dim);
+	for (std::uint64_t j = 0; j < dim; j++) {
+		double sign = 1.0 - 2.0 * __builtin_parityll(t.z & j);
+		triplets.emplace_back(j, j ^ t.x, std::complex<double>(sign * t.re, sign * t.im));
 	}
-
 	return triplets;
 }
 
@@ -392,41 +818,23 @@ Term& Term::operator*=( const Term& v ) noexcept {
 
 	coeff() *= std::get<0>(v);
 
-	std::string ss;
-	std::string myVar = std::get<1>(*this);
-	std::string otherVar = std::get<1>(v);
-	if (!myVar.empty()) {
-		if (!otherVar.empty()) {
-			ss = myVar + " " + otherVar;
-		} else {
-			ss = myVar;
-		}
-	} else {
-		if(!otherVar.empty()) {
-			ss = otherVar;
+	// Variable products are space separated names
+	auto& myVar = std::get<1>(*this);
+	auto& otherVar = std::get<1>(v);
+	if (!otherVar.empty()) {
+		if (!myVar.empty()) {
+			myVar += " ";
 		}
+		myVar += otherVar;
 	}
 
-	std::get<1>(*this) = ss;
-
-	auto otherOps = std::get<2>(v);
-	for (auto& kv : otherOps) {
-		auto qubit = kv.first;
-		auto gate = kv.second;
-		if (ops().count(qubit)) {
-			// This means, we have a op on same qubit in both
-			// so we need to check its product
-			auto myGate = ops().at(qubit);
-			auto gate_coeff = pauliProducts.at(myGate + gate);
-			if (gate_coeff.second != "I") {
-				ops().at(kv.first) = gate_coeff.second;
-			} else {
-				ops().erase(kv.first);
-			}
-			coeff() *= gate_coeff.first;
-		} else if (gate != "I") {
-			ops().emplace(std::make_pair(qubit, gate));
-		}
+	// Multiply the packed strings, the product picks up a phase i^k
+	static const std::complex<double> phases[] = { { 1, 0 }, { 0, 1 },
+			{ -1, 0 }, { 0, -1 } };
+	auto k = PauliString::multiply(pauliString(), v.pauliString(),
+			pauliString());
+	if (k) {
+		coeff() *= phases[k];
 	}
 
 	return *this;
@@ -437,22 +845,111 @@ PauliOperator PauliOperator::eval(const std::map<std::string, std::complex<doubl
 
 	for (auto& kv : terms) {
 
-		auto id = kv.first;
 		auto term = kv.second;
 
-		for (auto& varVal : varToValMap) {
-			if (varVal.first == term.var()) {
+		if (!term.var().empty()) {
+			auto varVal = varToValMap.find(term.var());
+			if (varVal != varToValMap.end()) {
 				term.var() = "";
-				term.coeff() *= varVal.second;
+				term.coeff() *= varVal->second;
 			}
 		}
 
-		ret.terms.insert({id, term});
+		// Binding a variable may give this term the
+		// same key as another, so accumulate rather than insert
+		ret.terms.accumulate(std::move(term), 0.0);
 	}
 
 	return ret;
 }
 
+EvalPlan PauliOperator::compile(const std::vector<std::string>& variables) const {
+	return EvalPlan(*this, variables);
+}
+
+EvalPlan::EvalPlan(const PauliOperator& op,
+		const std::vector<std::string>& leading) {
+	std::unordered_map<std::string, int> interned;
+	auto intern = [&](const std::string& name) {
+		auto it = interned.find(name);
+		if (it != interned.end()) {
+			return it->second;
+		}
+		int id = variables.size();
+		interned.insert({name, id});
+		variables.push_back(name);
+		return id;
+	};
+
+	for (auto& name : leading) {
+		intern(name);
+	}
+
+	coeffs.reserve(op.terms.size());
+	targets.reserve(op.terms.size());
+	idPtr.reserve(op.terms.size() + 1);
+	idPtr.push_back(0);
+	for (auto& kv : op.terms) {
+		auto& t = kv.second;
+		auto& var = std::get<1>(t);
+		std::size_t start = 0;
+		while (start < var.size()) {
+			auto end = var.find(' ', start);
+			if (end == std::string::npos) {
+				end = var.size();
+			}
+			if (end > start) {
+				ids.push_back(intern(var.substr(start, end - start)));
+			}
+			start = end + 1;
+		}
+		idPtr.push_back(ids.size());
+		coeffs.push_back(t.coeff());
+
+		Term numeric(0.0, "", t.pauliString());
+		layout.terms.insert(numeric);
+		targets.push_back(layout.terms.find(numeric) - layout.terms.begin());
+	}
+}
+
+int EvalPlan::getVariableId(const std::string& name) const {
+	auto it = std::find(variables.begin(), variables.end(), name);
+	return it == variables.end() ? -1 : it - variables.begin();
+}
+
+template<typename Params>
+void EvalPlan::evalTerms(const Params& parameters, PauliOperator& out) const {
+	if (parameters.size() < variables.size()) {
+		xacc::error("EvalPlan needs " + std::to_string(variables.size())
+				+ " parameters, given " + std::to_string(parameters.size()) + ".");
+	}
+	if (out.terms.size() != layout.terms.size()) {
+		xacc::error("EvalPlan can only evaluate into an operator from instantiate().");
+	}
+
+	auto first = out.terms.begin();
+	for (auto it = first; it != out.terms.end(); ++it) {
+		it->second.coeff() = 0.0;
+	}
+	for (std::size_t i = 0; i < coeffs.size(); i++) {
+		auto c = coeffs[i];
+		for (auto k = idPtr[i]; k < idPtr[i + 1]; k++) {
+			c *= parameters[ids[k]];
+		}
+		(first + targets[i])->second.coeff() += c;
+	}
+}
+
+void EvalPlan::evalInto(const std::vector<std::complex<double>>& parameters,
+		PauliOperator& out) const {
+	evalTerms(parameters, out);
+}
+
+void EvalPlan::evalInto(const Eigen::VectorXd& parameters,
+		PauliOperator& out) const {
+	evalTerms(parameters, out);
+}
+
 std::shared_ptr<IR> PauliOperator::toXACCIR() {
 // Create a new GateQIR to hold the spin based terms
 	auto gateRegistry = xacc::getService<IRProvider>("gate");
@@ -463,14 +960,14 @@ std::shared_ptr<IR> PauliOperator::toXACCIR() {
 	// Populate GateQIR now...
 	for (auto& inst : terms) {
 
-		Term spinInst = inst.second;
+		auto& spinInst = inst.second;
 
 		// Create a GateFunction and specify that it has
 		// a parameter that is the Spin Instruction coefficient
 		// that will help us get it to the user for their purposes.
 
 		auto gateFunction = gateRegistry->createFunction(
-				inst.first, {},
+				spinInst.id(), {},
 				std::vector<InstructionParameter> { InstructionParameter(
 						spinInst.coeff()), InstructionParameter(
 						spinInst.isIdentity() ? 1 : 0) });
@@ -478,14 +975,11 @@ std::shared_ptr<IR> PauliOperator::toXACCIR() {
 		// Loop over all terms in the Spin Instruction
 		// and create instructions to run on the Gate QPU.
 		std::vector<std::shared_ptr<xacc::Instruction>> measurements;
-		auto termsMap = spinInst.ops();
 
-		std::vector<std::pair<int, std::string>> terms;
-		for (auto& kv : termsMap) {
-			if (kv.second != "I" && !kv.second.empty()) {
-				terms.push_back( { kv.first, kv.second });
-			}
-		}
+		std::vector<std::pair<int, char>> terms;
+		spinInst.pauliString().forEachOp([&](const int q, const char op) {
+			terms.push_back( { q, op });
+		});
 
 		for (int i = terms.size() - 1; i >= 0; i--) {
 			auto qbit = terms[i].first;
@@ -496,11 +990,11 @@ std::shared_ptr<IR> PauliOperator::toXACCIR() {
 			meas->setParameter(0, classicalIdx);
 			measurements.push_back(meas);
 
-			if (gateName == "X") {
+			if (gateName == 'X') {
 				auto hadamard = gateRegistry->createInstruction("H", std::vector<int> {
 						qbit });
 				gateFunction->addInstruction(hadamard);
-			} else if (gateName == "Y") {
+			} else if (gateName == 'Y') {
 				auto rx = gateRegistry->createInstruction("Rx", std::vector<int> { qbit });
 				InstructionParameter p(pi / 2.0);
 				rx->setParameter(0, p);
@@ -523,7 +1017,7 @@ std::shared_ptr<IR> PauliOperator::toXACCIR() {
 
 void PauliOperator::fromXACCIR(std::shared_ptr<IR> ir) {
 
-	terms.clear();
+	clear();
 
 	for (auto& kernel : ir->getKernels()) {
 		std::map<int, std::string> pauliTerm;
@@ -545,8 +1039,7 @@ void PauliOperator::fromXACCIR(std::shared_ptr<IR> ir) {
 			c = boost::get<std::complex<double>>(kernel->getParameter(0));
 		}
 
-		Term t(c, pauliTerm);
-		terms.insert({t.id(), t});
+		terms.insert(Term(c, pauliTerm));
 
 	}
 }
@@ -556,20 +1049,24 @@ void PauliOperator::fromXACCIR(std::shared_ptr<IR> ir) {
 
 bool operator==(const xacc::vqe::PauliOperator& lhs,
 		const xacc::vqe::PauliOperator& rhs) {
-	if (lhs.getTerms().size() != rhs.getTerms().size()) {
+	auto lhsTerms = lhs.getTermView();
+	auto rhsTerms = rhs.getTermView();
+	if (lhsTerms.size() != rhsTerms.size()) {
 		return false;
 	}
-	for (auto& kv : lhs.getTerms()) {
-		bool found = false;
-		for (auto& vkv : rhs.getTerms()) {
 
-			if (kv.second.operator==(vkv.second)) {
-				found = true;
-				break;
+	if (lhs.isCanonical() && rhs.isCanonical()) {
+		// Both are sorted, so compare them term by term
+		for (std::size_t i = 0; i < lhsTerms.size(); i++) {
+			if (!(lhsTerms[i] == rhsTerms[i])) {
+				return false;
 			}
 		}
+		return true;
+	}
 
-		if (!found) {
+	for (auto& t : lhsTerms) {
+		if (!rhs.hasTerm(t)) {
 			return false;
 		}
 	}
@@ -34,8 +34,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <map>
+#include <functional>
 #include <unsupported/Eigen/KroneckerProduct>
+#include <Eigen/Sparse>
 #include "XACC.hpp"
+#include "PauliString.hpp"
+#include "TermMap.hpp"
 
 // Putting this here due to clang error
 // not able to find operator!= from operators.hpp
@@ -54,9 +58,10 @@ namespace xacc {
 namespace vqe {
 
 // A Term can be a coefficient, a variable coefficient, and the terms themselves
-using TermTuple = std::tuple<std::complex<double>, std::string, std::map<int, std::string>>;
+using TermTuple = std::tuple<std::complex<double>, std::string, PauliString>;
 using c = std::complex<double>;
 using ActionResult = std::pair<std::string, c>;
+using BasisAction = std::pair<std::uint64_t, c>;
 enum ActionType {Bra, Ket};
 class Triplet : std::tuple<std::uint64_t, std::uint64_t, std::complex<double>> {
 public:
@@ -70,105 +75,88 @@ public:
 	const std::complex<double> coeff() {return std::get<2>(*this);}
 };
 
+/**
+ * A matrix in compressed sparse row form. The nonzeros of row i
+ * are colIdx[k] and values[k] for k in [rowPtr[i], rowPtr[i+1]),
+ * in increasing column order.
+ */
+struct CSRMatrix {
+	std::uint64_t nRows = 0;
+	std::uint64_t nCols = 0;
+	std::vector<std::int64_t> rowPtr;
+	std::vector<std::int64_t> colIdx;
+	std::vector<std::complex<double>> values;
+};
+
+using SparseMatrix = Eigen::SparseMatrix<std::complex<double>, Eigen::RowMajor, std::int64_t>;
+
 class Term: public TermTuple,
 		public tao::operators::commutative_multipliable<Term>,
 		public tao::operators::equality_comparable<Term> {
 
-protected:
-
-	static std::map<std::string, std::pair<c, std::string>> create_map() {
-		static std::map<std::string, std::pair<c, std::string>> m;
-		m.insert( { "II", { c(1.0, 0.0), "I" } });
-		m.insert( { "IX", { c(1.0, 0.0), "X" } });
-		m.insert( { "XI", { c(1.0, 0.0), "X" } });
-		m.insert( { "IY", { c(1.0, 0.0), "Y" } });
-		m.insert( { "YI", { c(1.0, 0.0), "Y" } });
-		m.insert( { "ZI", { c(1.0, 0.0), "Z" } });
-		m.insert( { "IZ", { c(1.0, 0.0), "Z" } });
-		m.insert( { "XX", { c(1.0, 0.0), "I" } });
-		m.insert( { "YY", { c(1.0, 0.0), "I" } });
-		m.insert( { "ZZ", { c(1.0, 0.0), "I" } });
-		m.insert( { "XY", { c(0.0, 1.0), "Z" } });
-		m.insert( { "XZ", { c(0.0, -1.0), "Y" } });
-		m.insert( { "YX", { c(0.0, -1.0), "Z" } });
-		m.insert( { "YZ", { c(0.0, 1.0), "X" } });
-		m.insert( { "ZX", { c(0.0, 1.0), "Y" } });
-		m.insert( { "ZY", { c(0.0, -1.0), "X" } });
-		return m;
-	}
-
-	static const std::map<std::string, std::pair<c, std::string>> pauliProducts;
-
 public:
 
 	Term() {
 		std::get<0>(*this) = std::complex<double>(0, 0);
 		std::get<1>(*this) = "";
-		std::get<2>(*this) = { };
-	}
-
-	Term(const Term& t) {
-		std::get<0>(*this) = std::get<0>(t);
-		std::get<1>(*this) = std::get<1>(t);
-		std::get<2>(*this) = std::get<2>(t);
 	}
 
 	Term(std::complex<double> c) {
 		std::get<0>(*this) = c;
 		std::get<1>(*this) = "";
-		std::get<2>(*this) = { };
 	}
 
 	Term(double c) {
 		std::get<0>(*this) = std::complex<double>(c, 0);
 		std::get<1>(*this) = "";
-		std::get<2>(*this) = { };
 	}
 
 	Term(std::complex<double> c, std::map<int, std::string> ops) {
 		std::get<0>(*this) = c;
 		std::get<1>(*this) = "";
-		std::get<2>(*this) = ops;
+		std::get<2>(*this) = PauliString(ops);
 	}
 
 	Term(std::string var) {
 		std::get<0>(*this) = std::complex<double>(1,0);
 		std::get<1>(*this) = var;
-		std::get<2>(*this) = {};
 	}
 
 	Term(std::complex<double> c, std::string var) {
 		std::get<0>(*this) = c;
 		std::get<1>(*this) = var;
-		std::get<2>(*this) = { };
 	}
 
 	Term(std::string var, std::map<int, std::string> ops) {
 		std::get<0>(*this) = std::complex<double>(1,0);
 		std::get<1>(*this) = var;
-		std::get<2>(*this) = ops;
+		std::get<2>(*this) = PauliString(ops);
 	}
 
 	Term(std::complex<double> c, std::string var, std::map<int, std::string> ops) {
 		std::get<0>(*this) = c;
 		std::get<1>(*this) = var;
-		std::get<2>(*this) = ops;
+		std::get<2>(*this) = PauliString(ops);
 	}
 
 	Term(std::map<int, std::string> ops) {
 		std::get<0>(*this) = std::complex<double>(1,0);
 		std::get<1>(*this) = "";
+		std::get<2>(*this) = PauliString(ops);
+	}
+
+	Term(std::complex<double> c, std::string var, const PauliString& ops) {
+		std::get<0>(*this) = c;
+		std::get<1>(*this) = var;
 		std::get<2>(*this) = ops;
 	}
 
-	static const std::string id(const std::map<int, std::string>& ops, const std::string& var = "") {
-		std::string s;
-		s = var;
-		for (auto& t : ops) {
-			if (t.second != "I") {
-				s += t.second + std::to_string(t.first);
-			}
-		}
+	static const std::string id(const PauliString& ops, const std::string& var = "") {
+		std::string s = var;
+		ops.forEachOp([&](const int q, const char op) {
+			s += op;
+			s += std::to_string(q);
+		});
 
 		if (s.empty()) {
 			return "I";
@@ -177,54 +165,172 @@ public:
 		return s;
 	}
 
+	static const std::string id(const std::map<int, std::string>& ops, const std::string& var = "") {
+		return id(PauliString(ops), var);
+	}
+
 	const std::string id() const {
-		std::string s;
-		s = std::get<1>(*this);
-		for (auto& t : std::get<2>(*this)) {
-			if (t.second != "I") {
-				s += t.second + std::to_string(t.first);
-			}
-		}
+		return id(std::get<2>(*this), std::get<1>(*this));
+	}
 
-		if (s.empty()) {
-			return "I";
+	/**
+	 * Return a 64-bit hash of this Term's operators and
+	 * variable, used to key it in a PauliOperator.
+	 */
+	const std::uint64_t hash() const {
+		auto h = std::get<2>(*this).hash();
+		auto& v = std::get<1>(*this);
+		if (!v.empty()) {
+			h ^= std::hash<std::string>()(v) + 0x9e3779b97f4a7c15ULL + (h << 6)
+					+ (h >> 2);
 		}
+		return h;
+	}
 
-		return s;
+	/**
+	 * Return the map-based qubit-to-pauli view of this Term.
+	 * Prefer pauliString() on performance critical paths.
+	 */
+	std::map<int, std::string> ops() const {
+		return std::get<2>(*this).toMap();
 	}
 
-	std::map<int, std::string>& ops() {
+	/**
+	 * Return the packed symplectic representation of this Term.
+	 */
+	PauliString& pauliString() {
 		return std::get<2>(*this);
 	}
 
-	bool isIdentity() {
-		if (ops().empty()) {
-			return true;
-		} else {
-			return false;
-		}
+	const PauliString& pauliString() const {
+		return std::get<2>(*this);
+	}
+
+	bool isIdentity() const {
+		return std::get<2>(*this).isIdentity();
 	}
 
 	std::complex<double>& coeff() {
 		return std::get<0>(*this);
 	}
 
+	const std::complex<double>& coeff() const {
+		return std::get<0>(*this);
+	}
+
 	std::string& var() {
 		return std::get<1>(*this);
 	}
 
+	/**
+	 * Order Terms by their packed operators, then by variable.
+	 * This is the canonical order of PauliOperator::canonicalize().
+	 */
+	static bool lessKey(const Term& a, const Term& b) {
+		auto& pa = std::get<2>(a);
+		auto& pb = std::get<2>(b);
+		if (pa != pb) {
+			return pa < pb;
+		}
+		return std::get<1>(a) < std::get<1>(b);
+	}
+
+	/**
+	 * Return true if this Term commutes with the given Term.
+	 */
+	bool commutes(const Term& v) const {
+		return std::get<2>(*this).commutes(std::get<2>(v));
+	}
+
 	Term& operator*=( const Term& v ) noexcept;
 
-	bool operator==( const Term& v ) noexcept {
-		return std::get<1>(*this) == std::get<1>(v) && ops() == std::get<2>(v);
+	bool operator==( const Term& v ) const noexcept {
+		return std::get<1>(*this) == std::get<1>(v) && std::get<2>(*this) == std::get<2>(v);
 	}
 
-	std::vector<Triplet> getSparseMatrixElements(const int nQubits);
+	/**
+	 * Return the nonzero matrix elements of this term on
+	 * nQubits qubits, one per row, in row order.
+	 *
+	 * @param nQubits The number of qubits
+	 * @return elements The (row, column, value) triplets
+	 */
+	std::vector<Triplet> getSparseMatrixElements(const int nQubits) const;
 
 	ActionResult action(const std::string& bitString, ActionType type);
 
 };
 
+/**
+ * The TermView is a non-owning, read-only view of the terms
+ * of a PauliOperator, in the operator's iteration order. It
+ * is valid until the operator it views is next modified.
+ */
+class TermView {
+
+public:
+
+	using value_type = TermMap<Term>::value_type;
+
+	class const_iterator {
+	protected:
+		const value_type* ptr;
+	public:
+		const_iterator(const value_type* p) : ptr(p) {
+		}
+		const Term& operator*() const {
+			return ptr->second;
+		}
+		const Term* operator->() const {
+			return &ptr->second;
+		}
+		const_iterator& operator++() {
+			++ptr;
+			return *this;
+		}
+		bool operator==(const const_iterator& other) const {
+			return ptr == other.ptr;
+		}
+		bool operator!=(const const_iterator& other) const {
+			return ptr != other.ptr;
+		}
+	};
+
+protected:
+
+	const value_type* first;
+	const value_type* last;
+
+public:
+
+	TermView(const value_type* f, const value_type* l) :
+			first(f), last(l) {
+	}
+
+	const_iterator begin() const {
+		return const_iterator(first);
+	}
+
+	const_iterator end() const {
+		return const_iterator(last);
+	}
+
+	std::size_t size() const {
+		return last - first;
+	}
+
+	bool empty() const {
+		return first == last;
+	}
+
+	const Term& operator[](const std::size_t i) const {
+		return first[i].second;
+	}
+};
+
+class EvalPlan;
+class MappedPauliOperator;
+
 class PauliOperator: public tao::operators::commutative_ring<PauliOperator>,
 		public tao::operators::equality_comparable<PauliOperator>,
 		public tao::operators::commutative_multipliable<PauliOperator, double>,
@@ -232,17 +338,150 @@ class PauliOperator: public tao::operators::commutative_ring<PauliOperator>,
 				std::complex<double>> {
 protected:
 
-	std::unordered_map<std::string, Term> terms;
+	TermMap<Term> terms;
+
+	/**
+	 * True if terms are known to be in canonical order.
+	 */
+	bool canonical = false;
+
+	/**
+	 * The number of threads used by large products and sums.
+	 */
+	static int nThreads;
+
+	/**
+	 * True on threads already running in parallel with others,
+	 * whose operator arithmetic must not start more threads.
+	 */
+	static thread_local bool serialThread;
+
+	/**
+	 * Expand the product of factors[depth:] onto each partial
+	 * product partial[depth] and accumulate the results.
+	 */
+	void addProduct(
+			const std::vector<std::reference_wrapper<const PauliOperator>>& factors,
+			std::vector<Term>& partial, const std::size_t depth);
 
 public:
 
-	std::unordered_map<std::string, Term>::iterator begin() {
+	/**
+	 * Set the number of threads used to multiply and add
+	 * PauliOperators. Products of more than 2^14 term pairs
+	 * and sums adding more than 2^16 terms to an operator no
+	 * larger than the addend are split across this many
+	 * threads, smaller ones always run serially. Threads
+	 * holding a SerialScope always run serially.
+	 *
+	 * @param n The number of threads, 1 disables threading
+	 */
+	static void setNumThreads(const int n) {
+		nThreads = std::max(n, 1);
+	}
+
+	static const int getNumThreads() {
+		return nThreads;
+	}
+
+	/**
+	 * Return the number of threads the calling thread may use,
+	 * 1 inside a SerialScope and getNumThreads() otherwise.
+	 */
+	static int threadsHere() {
+		return serialThread ? 1 : nThreads;
+	}
+
+	/**
+	 * Run the operator arithmetic of the calling thread serially
+	 * while in scope. Workers that already split a computation
+	 * over threads hold one, so nested sums and products do not
+	 * start threads of their own.
+	 */
+	class SerialScope {
+		bool previous;
+	public:
+		SerialScope() : previous(serialThread) {
+			serialThread = true;
+		}
+		~SerialScope() {
+			serialThread = previous;
+		}
+	};
+
+	TermMap<Term>::iterator begin() {
+		return terms.begin();
+	}
+	TermMap<Term>::iterator end() {
+		return terms.end();
+	}
+	TermMap<Term>::const_iterator begin() const {
 		return terms.begin();
 	}
-	std::unordered_map<std::string, Term>::iterator end() {
+	TermMap<Term>::const_iterator end() const {
 		return terms.end();
 	}
 
+	/**
+	 * Return a view of this operator's terms that does
+	 * not copy them. The view is invalidated by any
+	 * modification of this operator.
+	 */
+	TermView getTermView() const {
+		return TermView(terms.data(), terms.data() + terms.size());
+	}
+
+	/**
+	 * Invoke f(term) for every term of this operator.
+	 *
+	 * @param f The functor to call with each const Term&
+	 */
+	template<typename F>
+	void forEachTerm(F f) const {
+		for (auto& kv : terms) {
+			f(kv.second);
+		}
+	}
+
+	/**
+	 * Sort this operator's terms into canonical order, by their
+	 * packed operators and then variable. Equality, closeness
+	 * and sums of canonical operators run as linear merges over
+	 * the sorted terms, and sums of canonical operators stay
+	 * canonical. Products and other modifications drop the
+	 * ordering, so read-only consumers should canonicalize
+	 * once the operator is complete.
+	 *
+	 * @return this This operator
+	 */
+	PauliOperator& canonicalize();
+
+	const bool isCanonical() const {
+		return canonical;
+	}
+
+	/**
+	 * Return true if this operator has a term with the
+	 * same operators and variable as t.
+	 */
+	bool hasTerm(const Term& t) const {
+		return terms.count(t);
+	}
+
+	/**
+	 * Add t to this operator, summing its coefficient into the
+	 * term with the same operators and variable if there is one.
+	 * Terms that cancel below 1e-12 are removed.
+	 *
+	 * @param t The term to add
+	 * @return this This operator
+	 */
+	PauliOperator& addTerm(Term t) {
+		canonical = false;
+		terms.accumulate(std::move(t), 1e-12);
+		return *this;
+	}
+
 	PauliOperator();
 	PauliOperator(std::complex<double> c);
 	PauliOperator(double c);
@@ -263,29 +502,310 @@ public:
 	const std::vector<std::pair<std::string, std::complex<double>>> computeActionOnBra(
 			const std::string& bitString);
 
+	/**
+	 * Apply this operator to the computational basis state |ket>,
+	 * where bit q of ket is the state of qubit q. The ith entry of
+	 * result is set to the basis index and coefficient produced by
+	 * the ith term. All terms must act on qubits below 64.
+	 *
+	 * @param ket The basis state index
+	 * @param result The buffer to fill, resized to nTerms()
+	 */
+	void computeActionOnKet(const std::uint64_t ket,
+			std::vector<BasisAction>& result) const;
+
+	/**
+	 * Apply this operator to the computational basis bra <bra|,
+	 * so that result holds the nonzero entries of row bra of
+	 * the operator's matrix. All terms must act on qubits below 64.
+	 *
+	 * @param bra The basis state index
+	 * @param result The buffer to fill, resized to nTerms()
+	 */
+	void computeActionOnBra(const std::uint64_t bra,
+			std::vector<BasisAction>& result) const;
+
+	/**
+	 * Apply this operator to a basis state of any number of
+	 * qubits, packed 64 qubits per word. Term i produces the
+	 * state in words [i*ket.size(), (i+1)*ket.size()) of states
+	 * with coefficient coeffs[i].
+	 *
+	 * @param ket The packed basis state
+	 * @param states The buffer of resultant states
+	 * @param coeffs The buffer of resultant coefficients
+	 */
+	void computeActionOnKet(const std::vector<std::uint64_t>& ket,
+			std::vector<std::uint64_t>& states,
+			std::vector<std::complex<double>>& coeffs) const;
+
+	void computeActionOnBra(const std::vector<std::uint64_t>& bra,
+			std::vector<std::uint64_t>& states,
+			std::vector<std::complex<double>>& coeffs) const;
+
+	/**
+	 * Compute out = H in for the dense state vector in over
+	 * nQubits qubits, where bit q of an amplitude's index is the
+	 * state of qubit q. No matrix is formed; rows are computed
+	 * from each term's masks in blocks spread over getNumThreads()
+	 * threads. All coefficients must be numeric and in and out
+	 * must not overlap.
+	 *
+	 * @param in The 2^nQubits input amplitudes
+	 * @param out The 2^nQubits output amplitudes, overwritten
+	 * @param nQubits The number of qubits
+	 */
+	void apply(const std::complex<double>* in, std::complex<double>* out,
+			const int nQubits) const;
+
+	/**
+	 * Apply this operator to nVectors state vectors stored one
+	 * after the other, as in the columns of an Eigen::MatrixXcd.
+	 *
+	 * @param in The nVectors * 2^nQubits input amplitudes
+	 * @param out The nVectors * 2^nQubits output amplitudes, overwritten
+	 * @param nQubits The number of qubits
+	 * @param nVectors The number of state vectors
+	 */
+	void apply(const std::complex<double>* in, std::complex<double>* out,
+			const int nQubits, const int nVectors) const;
+
 	const int nTerms();
 
 	const std::string toString();
 
 	void clear();
 
+	/**
+	 * Return a copy of this operator's terms keyed by their
+	 * string id. Prefer getTermView() or forEachTerm(), which
+	 * do not copy.
+	 */
 	std::unordered_map<std::string, Term> getTerms() const {
-		return terms;
+		std::unordered_map<std::string, Term> ret;
+		for (auto& kv : terms) {
+			ret.insert({kv.second.id(), kv.second});
+		}
+		return ret;
 	}
 
-	std::vector<Triplet> getSparseMatrixElements();
+	/**
+	 * Return the nonzero matrix elements of this operator, on
+	 * as many qubits as it acts on, in row-major order.
+	 */
+	std::vector<Triplet> getSparseMatrixElements() const;
+
+	/**
+	 * Return the nonzero matrix elements of this operator on
+	 * nQubits qubits in row-major order, with terms reaching the
+	 * same element merged.
+	 *
+	 * @param nQubits The number of qubits
+	 * @return elements The (row, column, value) triplets
+	 */
+	std::vector<Triplet> getSparseMatrixElements(const int nQubits) const;
+
+	/**
+	 * Build the CSR form of this operator's matrix on nQubits
+	 * qubits, where bit q of a row index is the state of qubit q.
+	 * Rows are built on getNumThreads() threads in two passes, one
+	 * sizing each row and one filling it, so no element is stored
+	 * twice. All coefficients must be numeric.
+	 *
+	 * @param nQubits The number of qubits
+	 * @return matrix The 2^nQubits by 2^nQubits CSR matrix
+	 */
+	CSRMatrix getCSRMatrix(const int nQubits) const;
+
+	/**
+	 * Build the CSR form of this operator restricted to the
+	 * subspace spanned by the given basis states. Row and column
+	 * i correspond to basis[i], and elements leaving the subspace
+	 * are dropped.
+	 *
+	 * @param basis The distinct basis state indices
+	 * @return matrix The basis.size() square CSR matrix
+	 */
+	CSRMatrix getCSRMatrix(const std::vector<std::uint64_t>& basis) const;
+
+	/**
+	 * Return getCSRMatrix(nQubits) as an Eigen sparse matrix.
+	 */
+	SparseMatrix getSparseMatrix(const int nQubits) const;
+
+	/**
+	 * Return getCSRMatrix(basis) as an Eigen sparse matrix.
+	 */
+	SparseMatrix getSparseMatrix(const std::vector<std::uint64_t>& basis) const;
+
 	std::shared_ptr<IR> toXACCIR();
 	void fromXACCIR(std::shared_ptr<IR> ir);
 	PauliOperator eval(const std::map<std::string, std::complex<double>> varToValMap);
 	bool isClose(PauliOperator& other);
 
+	/**
+	 * Write this operator to path in the versioned binary format
+	 * described by PauliOperatorFileHeader: packed masks,
+	 * coefficients and an interned variable table.
+	 *
+	 * @param path The file to write
+	 */
+	void save(const std::string& path) const;
+
+	/**
+	 * Read an operator written by save(). The file is memory-mapped
+	 * and its terms are copied straight out of the packed arrays;
+	 * use MappedPauliOperator to access them without any copy.
+	 *
+	 * @param path The file to read
+	 * @return op The loaded operator
+	 */
+	static PauliOperator load(const std::string& path);
+
+	/**
+	 * Return this operator in the binary format written by
+	 * save(), for instance to send it to another process.
+	 *
+	 * @return data The packed operator
+	 */
+	std::string pack() const;
+
+	/**
+	 * Build an operator from the output of pack().
+	 *
+	 * @param data The packed operator
+	 * @return op The unpacked operator
+	 */
+	static PauliOperator unpack(const std::string& data);
+
+	/**
+	 * Compile this operator's symbolic coefficients into an
+	 * EvalPlan. Variables are numbered in the order given, followed
+	 * by any others in the order they first appear in the terms.
+	 *
+	 * @param variables The leading variable names
+	 * @return plan The compiled evaluation plan
+	 */
+	EvalPlan compile(const std::vector<std::string>& variables = {}) const;
+
+	/**
+	 * Return the hermitian adjoint of this operator. Pauli
+	 * strings are self-adjoint, so this conjugates every
+	 * coefficient; variables are taken to be real.
+	 *
+	 * @return adjoint The adjoint operator
+	 */
+	PauliOperator hermitianConjugate() const;
+
+	/**
+	 * Add coeff * factors[0] * factors[1] * ... to this operator,
+	 * expanding the product term by term straight into this
+	 * operator's terms without building intermediate operators.
+	 * This is equivalent to, but much cheaper than,
+	 * *this += coeff * factors[0] * factors[1] * ...
+	 *
+	 * @param coeff The coefficient multiplying the product
+	 * @param factors The operators to multiply, in order
+	 * @return this The updated operator
+	 */
+	PauliOperator& addProduct(const std::complex<double> coeff,
+			const std::vector<std::reference_wrapper<const PauliOperator>>& factors);
+
 	PauliOperator& operator+=( const PauliOperator& v ) noexcept;
 	PauliOperator& operator-=( const PauliOperator& v ) noexcept;
 	PauliOperator& operator*=( const PauliOperator& v ) noexcept;
 	bool operator==( const PauliOperator& v ) noexcept;
 	PauliOperator& operator*=( const double v ) noexcept;
 	PauliOperator& operator*=( const std::complex<double> v ) noexcept;
+
+	friend class EvalPlan;
+	friend class MappedPauliOperator;
 };
+
+/**
+ * An EvalPlan binds all the variables of a symbolic PauliOperator
+ * from a dense parameter vector. Variable names are interned to
+ * integer ids when the plan is compiled, each source term records
+ * the ids in its (space separated) variable product and the numeric
+ * term it contributes to, so evaluation is a single pass over the
+ * terms with no string work or allocation.
+ */
+class EvalPlan {
+
+protected:
+
+	std::vector<std::string> variables;
+
+	/**
+	 * Source term i has coefficient coeffs[i], is multiplied by the
+	 * parameters ids[idPtr[i]..idPtr[i+1]), and adds into term
+	 * targets[i] of the numeric operator.
+	 */
+	std::vector<std::complex<double>> coeffs;
+	std::vector<std::size_t> idPtr;
+	std::vector<int> ids;
+	std::vector<std::size_t> targets;
+
+	/**
+	 * The numeric operator, with one zero-coefficient term per
+	 * distinct Pauli string.
+	 */
+	PauliOperator layout;
+
+public:
+
+	EvalPlan(const PauliOperator& op, const std::vector<std::string>& leading);
+
+	/**
+	 * Return the variable names, indexed by id.
+	 */
+	const std::vector<std::string>& getVariables() const {
+		return variables;
+	}
+
+	std::size_t nVariables() const {
+		return variables.size();
+	}
+
+	/**
+	 * Return the id of the given variable, or -1.
+	 */
+	int getVariableId(const std::string& name) const;
+
+	/**
+	 * Return a numeric operator laid out for evalInto().
+	 */
+	PauliOperator instantiate() const {
+		return layout;
+	}
+
+	/**
+	 * Overwrite the coefficients of out, which must come from
+	 * instantiate(), with this plan evaluated at parameters.
+	 *
+	 * @param parameters The value of each variable, indexed by id
+	 * @param out The numeric operator to update in place
+	 */
+	void evalInto(const std::vector<std::complex<double>>& parameters,
+			PauliOperator& out) const;
+
+	void evalInto(const Eigen::VectorXd& parameters, PauliOperator& out) const;
+
+	/**
+	 * Return this plan evaluated at parameters.
+	 */
+	PauliOperator eval(const std::vector<std::complex<double>>& parameters) const {
+		auto out = instantiate();
+		evalInto(parameters, out);
+		return out;
+	}
+
+protected:
+
+	template<typename Params>
+	void evalTerms(const Params& parameters, PauliOperator& out) const;
+};
+
 }
 }
 
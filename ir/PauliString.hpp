@@ -0,0 +1,430 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_PAULISTRING_HPP_
+#define VQE_IR_PAULISTRING_HPP_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The PauliString is a bit-packed, symplectic representation of
+ * a tensor product of single qubit Pauli operators. Each qubit q
+ * is described by a pair of bits (x_q, z_q) in two multi-word masks,
+ * with I = (0,0), X = (1,0), Z = (0,1) and Y = (1,1).
+ *
+ * Products of PauliStrings reduce to an XOR of the masks plus
+ * a popcount-based phase, and commutation checks reduce to the
+ * symplectic inner product of the masks.
+ *
+ * Masks of up to InlineWords 64-bit words (128 qubits) are stored
+ * inline, so the common case never touches the heap.
+ */
+class PauliString {
+
+public:
+
+	/**
+	 * The number of 64-bit words per mask stored inline.
+	 */
+	static const int InlineWords = 2;
+
+protected:
+
+	/**
+	 * The number of 64-bit words in each of the x and z masks.
+	 */
+	std::uint32_t nw = 0;
+
+	/**
+	 * Inline storage, x words in [0,InlineWords), z words
+	 * in [InlineWords, 2*InlineWords).
+	 */
+	std::uint64_t local[2 * InlineWords] = { 0, 0, 0, 0 };
+
+	/**
+	 * Heap storage used when nw > InlineWords, x words
+	 * in [0,nw), z words in [nw, 2*nw).
+	 */
+	std::vector<std::uint64_t> ext;
+
+	static int popcount(const std::uint64_t w) {
+		return __builtin_popcountll(w);
+	}
+
+	/**
+	 * Grow the masks so that they hold at least n words,
+	 * preserving the current contents.
+	 */
+	void resize(const std::uint32_t n) {
+		if (n <= nw) {
+			return;
+		}
+
+		if (n <= InlineWords) {
+			nw = n;
+			return;
+		}
+
+		std::vector<std::uint64_t> newExt(2 * n, 0);
+		for (std::uint32_t i = 0; i < nw; i++) {
+			newExt[i] = x(i);
+			newExt[n + i] = z(i);
+		}
+		ext.swap(newExt);
+		nw = n;
+	}
+
+	std::uint64_t* xPtr() {
+		return nw > InlineWords ? ext.data() : local;
+	}
+
+	std::uint64_t* zPtr() {
+		return nw > InlineWords ? ext.data() + nw : local + InlineWords;
+	}
+
+public:
+
+	PauliString() {
+	}
+
+	/**
+	 * Construct from the map-based qubit-to-pauli representation,
+	 * for example {{0,"X"}, {3,"Z"}}. Identity entries are dropped.
+	 *
+	 * @param ops The qubit-to-pauli map
+	 */
+	PauliString(const std::map<int, std::string>& ops) {
+		for (auto& kv : ops) {
+			set(kv.first, kv.second);
+		}
+	}
+
+	/**
+	 * Construct from packed masks of n words each. Trailing
+	 * zero words are dropped.
+	 *
+	 * @param xs The x mask words
+	 * @param zs The z mask words
+	 * @param n The number of words in each mask
+	 */
+	PauliString(const std::uint64_t* xs, const std::uint64_t* zs,
+			std::uint32_t n) {
+		while (n > 0 && !(xs[n - 1] | zs[n - 1])) {
+			n--;
+		}
+		resize(n);
+		std::copy(xs, xs + n, xPtr());
+		std::copy(zs, zs + n, zPtr());
+	}
+
+	/**
+	 * Return the number of 64-bit words in each mask.
+	 */
+	const std::uint32_t nWords() const {
+		return nw;
+	}
+
+	/**
+	 * Return the ith word of the x mask, zero if out of range.
+	 */
+	std::uint64_t x(const std::uint32_t i) const {
+		return i < nw ?
+				(nw > InlineWords ? ext[i] : local[i]) : 0;
+	}
+
+	/**
+	 * Return the ith word of the z mask, zero if out of range.
+	 */
+	std::uint64_t z(const std::uint32_t i) const {
+		return i < nw ?
+				(nw > InlineWords ? ext[nw + i] : local[InlineWords + i]) : 0;
+	}
+
+	/**
+	 * Set the Pauli operator acting on the given qubit.
+	 *
+	 * @param qubit The qubit index
+	 * @param op One of I, X, Y, or Z
+	 */
+	void set(const int qubit, const char op) {
+		auto w = static_cast<std::uint32_t>(qubit) >> 6;
+		auto bit = std::uint64_t(1) << (qubit & 63);
+		if (op == 'I' && w >= nw) {
+			return;
+		}
+		resize(w + 1);
+		auto xs = xPtr();
+		auto zs = zPtr();
+		xs[w] &= ~bit;
+		zs[w] &= ~bit;
+		if (op == 'X' || op == 'Y') {
+			xs[w] |= bit;
+		}
+		if (op == 'Z' || op == 'Y') {
+			zs[w] |= bit;
+		}
+	}
+
+	void set(const int qubit, const std::string& op) {
+		set(qubit, op.empty() ? 'I' : op[0]);
+	}
+
+	/**
+	 * Return the Pauli operator acting on the given qubit
+	 * as one of I, X, Y, or Z.
+	 *
+	 * @param qubit The qubit index
+	 * @return op The operator character
+	 */
+	const char get(const int qubit) const {
+		auto w = static_cast<std::uint32_t>(qubit) >> 6;
+		auto bit = std::uint64_t(1) << (qubit & 63);
+		bool xb = x(w) & bit, zb = z(w) & bit;
+		return xb ? (zb ? 'Y' : 'X') : (zb ? 'Z' : 'I');
+	}
+
+	/**
+	 * Return true if this is the identity operator.
+	 */
+	bool isIdentity() const {
+		for (std::uint32_t i = 0; i < nw; i++) {
+			if (x(i) | z(i)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Return the number of non-identity operators in this string.
+	 */
+	const int weight() const {
+		int w = 0;
+		for (std::uint32_t i = 0; i < nw; i++) {
+			w += popcount(x(i) | z(i));
+		}
+		return w;
+	}
+
+	/**
+	 * Return the number of Y operators in this string.
+	 */
+	const int nY() const {
+		int n = 0;
+		for (std::uint32_t i = 0; i < nw; i++) {
+			n += popcount(x(i) & z(i));
+		}
+		return n;
+	}
+
+	/**
+	 * Return the largest qubit index with a non-identity
+	 * operator, or -1 if this is the identity.
+	 */
+	const int maxQubit() const {
+		for (int i = nw - 1; i >= 0; i--) {
+			auto w = x(i) | z(i);
+			if (w) {
+				return 64 * i + 63 - __builtin_clzll(w);
+			}
+		}
+		return -1;
+	}
+
+	/**
+	 * Invoke f(qubit, op) for every non-identity operator
+	 * in order of increasing qubit index.
+	 *
+	 * @param f The functor to call
+	 */
+	template<typename F>
+	void forEachOp(F f) const {
+		for (std::uint32_t i = 0; i < nw; i++) {
+			auto xw = x(i), zw = z(i);
+			auto w = xw | zw;
+			while (w) {
+				auto b = __builtin_ctzll(w);
+				auto bit = std::uint64_t(1) << b;
+				f(64 * i + b, (xw & bit) ? ((zw & bit) ? 'Y' : 'X') : 'Z');
+				w &= w - 1;
+			}
+		}
+	}
+
+	/**
+	 * Return the map-based qubit-to-pauli representation
+	 * of this string.
+	 */
+	std::map<int, std::string> toMap() const {
+		std::map<int, std::string> ops;
+		forEachOp([&](const int q, const char op) {
+			ops.emplace(q, std::string(1, op));
+		});
+		return ops;
+	}
+
+	/**
+	 * Return true if this string commutes with the other,
+	 * that is, if their symplectic inner product is zero.
+	 *
+	 * @param other The other PauliString
+	 * @return commutes
+	 */
+	bool commutes(const PauliString& other) const {
+		auto n = std::max(nw, other.nw);
+		int parity = 0;
+		for (std::uint32_t i = 0; i < n; i++) {
+			parity ^= popcount((x(i) & other.z(i)) ^ (z(i) & other.x(i))) & 1;
+		}
+		return parity == 0;
+	}
+
+	/**
+	 * Compute the product a * b, storing the resultant
+	 * string in result, and returning the power k of the
+	 * phase i^k multiplying it. result may alias a or b.
+	 *
+	 * @param a The left operand
+	 * @param b The right operand
+	 * @param result The product string
+	 * @return k The phase exponent, in [0,4)
+	 */
+	static int multiply(const PauliString& a, const PauliString& b,
+			PauliString& result) {
+		auto n = std::max(a.nw, b.nw);
+		int k = 0;
+		std::uint64_t rx[InlineWords], rz[InlineWords];
+		std::vector<std::uint64_t> big;
+		std::uint64_t *xs = rx, *zs = rz;
+		if (n > InlineWords) {
+			big.resize(2 * n);
+			xs = big.data();
+			zs = big.data() + n;
+		}
+
+		for (std::uint32_t i = 0; i < n; i++) {
+			auto x1 = a.x(i), z1 = a.z(i), x2 = b.x(i), z2 = b.z(i);
+			auto X1 = x1 & ~z1, Y1 = x1 & z1, Z1 = ~x1 & z1;
+			auto X2 = x2 & ~z2, Y2 = x2 & z2, Z2 = ~x2 & z2;
+
+			// XY = iZ, YZ = iX, ZX = iY and the reverse products get -i
+			auto plus = (X1 & Y2) | (Y1 & Z2) | (Z1 & X2);
+			auto minus = (Y1 & X2) | (Z1 & Y2) | (X1 & Z2);
+			k += popcount(plus) + 3 * popcount(minus);
+
+			xs[i] = x1 ^ x2;
+			zs[i] = z1 ^ z2;
+		}
+
+		result.resize(n);
+		auto outX = result.xPtr(), outZ = result.zPtr();
+		for (std::uint32_t i = 0; i < n; i++) {
+			outX[i] = xs[i];
+			outZ[i] = zs[i];
+		}
+		for (std::uint32_t i = n; i < result.nw; i++) {
+			outX[i] = 0;
+			outZ[i] = 0;
+		}
+
+		return k & 3;
+	}
+
+	/**
+	 * Return a 64-bit hash of this string. Trailing zero
+	 * words do not contribute, so equal strings of different
+	 * widths hash identically.
+	 */
+	std::uint64_t hash() const {
+		std::uint64_t h = 0x9e3779b97f4a7c15ULL;
+		auto mix = [](std::uint64_t v) {
+			v ^= v >> 33;
+			v *= 0xff51afd7ed558ccdULL;
+			v ^= v >> 33;
+			v *= 0xc4ceb9fe1a85ec53ULL;
+			v ^= v >> 33;
+			return v;
+		};
+		int last = nw - 1;
+		while (last >= 0 && !(x(last) | z(last))) {
+			last--;
+		}
+		for (int i = 0; i <= last; i++) {
+			h = mix(h ^ x(i)) + 0x9e3779b97f4a7c15ULL;
+			h = mix(h ^ z(i)) + 0x9e3779b97f4a7c15ULL;
+		}
+		return h;
+	}
+
+	bool operator==(const PauliString& other) const {
+		auto n = std::max(nw, other.nw);
+		for (std::uint32_t i = 0; i < n; i++) {
+			if (x(i) != other.x(i) || z(i) != other.z(i)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool operator!=(const PauliString& other) const {
+		return !operator==(other);
+	}
+
+	/**
+	 * Lexicographic ordering on the packed (z,x) words,
+	 * starting from the highest word.
+	 */
+	bool operator<(const PauliString& other) const {
+		int n = std::max(nw, other.nw);
+		for (int i = n - 1; i >= 0; i--) {
+			if (z(i) != other.z(i)) {
+				return z(i) < other.z(i);
+			}
+			if (x(i) != other.x(i)) {
+				return x(i) < other.x(i);
+			}
+		}
+		return false;
+	}
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,270 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include "QubitTapering.hpp"
+#include <boost/algorithm/string.hpp>
+
+namespace xacc {
+namespace vqe {
+
+QubitTapering QubitTapering::find(const PauliOperator& op, const int nQubits) {
+	QubitTapering t;
+	t.n = nQubits;
+	t.nw = (std::max(nQubits, 1) + 63) / 64;
+	auto nw = t.nw;
+
+	// Reduce the X masks of the terms to reduced row echelon form,
+	// each row's lowest qubit its pivot, cleared from every other row
+	std::vector<std::vector<std::uint64_t>> rows;
+	std::vector<int> pivots;
+	std::vector<std::uint64_t> x(nw);
+	op.forEachTerm([&](const Term& term) {
+		auto& p = term.pauliString();
+		if (p.maxQubit() >= nQubits) {
+			xacc::error("Term " + term.id() + " acts outside the "
+					+ std::to_string(nQubits) + " qubits to taper.");
+		}
+		for (std::size_t w = 0; w < nw; w++) {
+			x[w] = p.x(w);
+		}
+		for (std::size_t r = 0; r < rows.size(); r++) {
+			if ((x[pivots[r] >> 6] >> (pivots[r] & 63)) & 1) {
+				for (std::size_t w = 0; w < nw; w++) {
+					x[w] ^= rows[r][w];
+				}
+			}
+		}
+		int pivot = -1;
+		for (std::size_t w = 0; w < nw && pivot < 0; w++) {
+			if (x[w]) {
+				pivot = 64 * w + __builtin_ctzll(x[w]);
+			}
+		}
+		if (pivot < 0) {
+			return;
+		}
+		for (auto& row : rows) {
+			if ((row[pivot >> 6] >> (pivot & 63)) & 1) {
+				for (std::size_t w = 0; w < nw; w++) {
+					row[w] ^= x[w];
+				}
+			}
+		}
+		rows.push_back(x);
+		pivots.push_back(pivot);
+	});
+
+	// Each free qubit f spans one kernel vector, f together with
+	// the pivots of the rows containing f
+	std::vector<bool> isPivot(nQubits, false);
+	for (auto p : pivots) {
+		isPivot[p] = true;
+	}
+	for (int f = 0; f < nQubits; f++) {
+		if (isPivot[f]) {
+			continue;
+		}
+		std::vector<std::uint64_t> support(nw);
+		support[f >> 6] |= std::uint64_t(1) << (f & 63);
+		for (std::size_t r = 0; r < rows.size(); r++) {
+			if ((rows[r][f >> 6] >> (f & 63)) & 1) {
+				support[pivots[r] >> 6] |= std::uint64_t(1) << (pivots[r] & 63);
+			}
+		}
+		t.supports.insert(t.supports.end(), support.begin(), support.end());
+		t.taperedQubits.push_back(f);
+	}
+
+	t.setRemaining();
+	return t;
+}
+
+void QubitTapering::setRemaining() {
+	remaining.clear();
+	for (int q = 0; q < n; q++) {
+		if (std::find(taperedQubits.begin(), taperedQubits.end(), q)
+				== taperedQubits.end()) {
+			remaining.push_back(q);
+		}
+	}
+}
+
+bool QubitTapering::commutes(const PauliString& p) const {
+	for (int i = 0; i < nSymmetries(); i++) {
+		int parity = 0;
+		for (std::size_t w = 0; w < nw; w++) {
+			parity ^= __builtin_popcountll(p.x(w) & supports[i * nw + w]) & 1;
+		}
+		if (parity) {
+			return false;
+		}
+	}
+	return true;
+}
+
+PauliOperator QubitTapering::commutingTerms(const PauliOperator& op) const {
+	PauliOperator result;
+	op.forEachTerm([&](const Term& term) {
+		if (commutes(term.pauliString())) {
+			result.addTerm(term);
+		}
+	});
+	return result;
+}
+
+PauliOperator QubitTapering::taper(const PauliOperator& op) const {
+	if (sectors.size() != nSymmetries()) {
+		xacc::error("Choose a sector before tapering.");
+	}
+
+	static const std::complex<double> phases[] = { { 1, 0 }, { 0, 1 },
+			{ -1, 0 }, { 0, -1 } };
+
+	// The rotation X_q tau conjugating each anticommuting term
+	std::vector<PauliString> rotations(nSymmetries());
+	std::vector<int> rotationPhases(nSymmetries());
+	for (int i = 0; i < nSymmetries(); i++) {
+		PauliString xq;
+		xq.set(taperedQubits[i], 'X');
+		rotationPhases[i] = PauliString::multiply(xq, symmetry(i), rotations[i]);
+	}
+
+	std::size_t nrw = (std::max(nReducedQubits(), 1) + 63) / 64;
+	std::vector<std::uint64_t> rx(nrw), rz(nrw);
+	PauliOperator reduced;
+	op.forEachTerm([&](const Term& term) {
+		auto p = term.pauliString();
+		if (!commutes(p)) {
+			xacc::error("Term " + term.id() + " does not commute with "
+					"the tapered symmetries.");
+		}
+
+		int k = 0;
+		for (int i = 0; i < nSymmetries(); i++) {
+			// U_i P U_i is P if P commutes with X_q, and X_q tau P if not
+			auto q = taperedQubits[i];
+			if ((p.z(q >> 6) >> (q & 63)) & 1) {
+				k += rotationPhases[i] + PauliString::multiply(rotations[i], p, p);
+			}
+		}
+
+		// Each X_q left is the eigenvalue of its symmetry
+		auto coeff = term.coeff() * phases[k & 3];
+		for (int i = 0; i < nSymmetries(); i++) {
+			auto q = taperedQubits[i];
+			if ((p.x(q >> 6) >> (q & 63)) & 1) {
+				coeff *= sectors[i];
+			}
+		}
+
+		std::fill(rx.begin(), rx.end(), 0);
+		std::fill(rz.begin(), rz.end(), 0);
+		for (std::size_t r = 0; r < remaining.size(); r++) {
+			auto q = remaining[r];
+			auto bit = std::uint64_t(1) << (r & 63);
+			if ((p.x(q >> 6) >> (q & 63)) & 1) {
+				rx[r >> 6] |= bit;
+			}
+			if ((p.z(q >> 6) >> (q & 63)) & 1) {
+				rz[r >> 6] |= bit;
+			}
+		}
+		reduced.addTerm(Term(coeff, std::get<1>(term),
+				PauliString(rx.data(), rz.data(), nrw)));
+	});
+
+	return reduced;
+}
+
+bool QubitTapering::reduceState(const std::uint64_t state,
+		std::uint64_t& reduced) const {
+	if (n > 64) {
+		xacc::error("Cannot reduce a basis state of "
+				+ std::to_string(n) + " qubits, at most 64 fit in a word.");
+	}
+	for (int i = 0; i < nSymmetries(); i++) {
+		auto parity = __builtin_popcountll(supports[i * nw] & state) & 1;
+		if ((parity ? -1 : 1) != sectors[i]) {
+			return false;
+		}
+	}
+	reduced = 0;
+	for (std::size_t r = 0; r < remaining.size(); r++) {
+		reduced |= ((state >> remaining[r]) & 1) << r;
+	}
+	return true;
+}
+
+std::string QubitTapering::toString() const {
+	std::stringstream s;
+	s << n;
+	for (int i = 0; i < nSymmetries(); i++) {
+		s << ";" << taperedQubits[i] << ":"
+				<< (i < sectors.size() ? sectors[i] : 1) << ":";
+		std::string support;
+		for (int q = 0; q < n; q++) {
+			if (inSupport(i, q)) {
+				support += (support.empty() ? "" : ".") + std::to_string(q);
+			}
+		}
+		s << support;
+	}
+	return s.str();
+}
+
+QubitTapering QubitTapering::fromString(const std::string& str) {
+	std::vector<std::string> symmetries;
+	boost::split(symmetries, str, boost::is_any_of(";"));
+
+	QubitTapering t;
+	t.n = std::stoi(symmetries[0]);
+	t.nw = (std::max(t.n, 1) + 63) / 64;
+	for (std::size_t i = 1; i < symmetries.size(); i++) {
+		std::vector<std::string> fields, qubits;
+		boost::split(fields, symmetries[i], boost::is_any_of(":"));
+		if (fields.size() != 3) {
+			xacc::error("Invalid qubit tapering " + str);
+		}
+		t.taperedQubits.push_back(std::stoi(fields[0]));
+		t.sectors.push_back(std::stoi(fields[1]));
+		std::vector<std::uint64_t> support(t.nw);
+		boost::split(qubits, fields[2], boost::is_any_of("."));
+		for (auto& q : qubits) {
+			auto idx = std::stoi(q);
+			support[idx >> 6] |= std::uint64_t(1) << (idx & 63);
+		}
+		t.supports.insert(t.supports.end(), support.begin(), support.end());
+	}
+	t.setRemaining();
+	return t;
+}
+
+}
+}
@@ -0,0 +1,212 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_QUBITTAPERING_HPP_
+#define VQE_IR_QUBITTAPERING_HPP_
+
+#include "PauliOperator.hpp"
+
+namespace xacc {
+namespace vqe {
+
+/**
+ * QubitTapering removes the qubits fixed by Z2 symmetries of a
+ * qubit Hamiltonian. The symmetries found are the Z strings Z_S
+ * commuting with every term, that is the sets S meeting the X part
+ * of every term an even number of times, a GF(2) kernel computed on
+ * the packed term masks. Each symmetry tau_i gets a qubit q_i in its
+ * own support and no other's, so the Clifford
+ *
+ * U = prod_i (X_{q_i} + tau_i) / sqrt(2)
+ *
+ * maps tau_i to X_{q_i}. Every transformed term then acts on q_i
+ * with I or X, which is replaced by the symmetry's eigenvalue in
+ * the chosen sector, and the q_i are dropped. The remaining qubits
+ * are renumbered in order.
+ */
+class QubitTapering {
+
+protected:
+
+	int n = 0;
+
+	std::size_t nw = 1;
+
+	/**
+	 * The support S_i of each symmetry, nw words each.
+	 */
+	std::vector<std::uint64_t> supports;
+
+	std::vector<int> taperedQubits;
+
+	std::vector<int> sectors;
+
+	/**
+	 * The original qubit of each reduced qubit.
+	 */
+	std::vector<int> remaining;
+
+	bool inSupport(const int i, const int q) const {
+		return (supports[i * nw + (q >> 6)] >> (q & 63)) & 1;
+	}
+
+	void setRemaining();
+
+public:
+
+	QubitTapering() {
+	}
+
+	/**
+	 * Find the Z2 symmetries of op, an operator on nQubits qubits.
+	 * Terms acting on qubits past nQubits are rejected.
+	 *
+	 * @param op The qubit Hamiltonian
+	 * @param nQubits The number of qubits
+	 * @return tapering The tapering, with no sector chosen yet
+	 */
+	static QubitTapering find(const PauliOperator& op, const int nQubits);
+
+	int nSymmetries() const {
+		return taperedQubits.size();
+	}
+
+	/**
+	 * Return the number of qubits before tapering.
+	 */
+	int nQubits() const {
+		return n;
+	}
+
+	int nReducedQubits() const {
+		return remaining.size();
+	}
+
+	/**
+	 * Return symmetry i as a Z string.
+	 */
+	PauliString symmetry(const int i) const {
+		std::vector<std::uint64_t> xs(nw);
+		return PauliString(xs.data(), supports.data() + i * nw, nw);
+	}
+
+	/**
+	 * Return the qubit tapered off by symmetry i.
+	 */
+	int taperedQubit(const int i) const {
+		return taperedQubits[i];
+	}
+
+	/**
+	 * Return the original qubit of each reduced qubit.
+	 */
+	const std::vector<int>& getRemainingQubits() const {
+		return remaining;
+	}
+
+	/**
+	 * Return the reduced qubit of original qubit q, or -1
+	 * if q is tapered off.
+	 */
+	int reducedQubit(const int q) const {
+		auto it = std::lower_bound(remaining.begin(), remaining.end(), q);
+		return it != remaining.end() && *it == q ? it - remaining.begin() : -1;
+	}
+
+	/**
+	 * Choose the sector by the eigenvalue, +1 or -1, of
+	 * each symmetry.
+	 */
+	void setSector(const std::vector<int>& eigenvalues) {
+		if (eigenvalues.size() != nSymmetries()) {
+			xacc::error("A tapering sector needs an eigenvalue for each of the "
+					+ std::to_string(nSymmetries()) + " symmetries.");
+		}
+		sectors = eigenvalues;
+	}
+
+	/**
+	 * Choose the sector containing the computational basis state
+	 * whose packed bits are state, such as a reference state.
+	 */
+	void setSector(const std::vector<std::uint64_t>& state) {
+		sectors.clear();
+		for (int i = 0; i < nSymmetries(); i++) {
+			int parity = 0;
+			for (std::size_t w = 0; w < nw && w < state.size(); w++) {
+				parity ^= __builtin_popcountll(supports[i * nw + w] & state[w]) & 1;
+			}
+			sectors.push_back(parity ? -1 : 1);
+		}
+	}
+
+	const std::vector<int>& getSector() const {
+		return sectors;
+	}
+
+	/**
+	 * Return true if p commutes with every symmetry.
+	 */
+	bool commutes(const PauliString& p) const;
+
+	/**
+	 * Return the terms of op that commute with every symmetry.
+	 * The others map each sector to another one.
+	 */
+	PauliOperator commutingTerms(const PauliOperator& op) const;
+
+	/**
+	 * Return op, whose terms must commute with every symmetry,
+	 * rotated, restricted to the sector and acting on the
+	 * reduced qubits.
+	 */
+	PauliOperator taper(const PauliOperator& op) const;
+
+	/**
+	 * Map a computational basis state on at most 64 qubits to
+	 * the reduced qubits. Return false if it lies outside the
+	 * sector. Taperings of more than 64 qubits are rejected.
+	 */
+	bool reduceState(const std::uint64_t state, std::uint64_t& reduced) const;
+
+	/**
+	 * Write this tapering as the number of qubits, then each
+	 * symmetry as its tapered qubit, eigenvalue and support,
+	 * for example 4;1:-1:0.1;3:1:0.1.2.3
+	 */
+	std::string toString() const;
+
+	static QubitTapering fromString(const std::string& str);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,408 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_TERMMAP_HPP_
+#define VQE_IR_TERMMAP_HPP_
+
+#include <cstdint>
+#include <complex>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The TermMap is a flat, open-addressing hash table of terms,
+ * keyed by each term's precomputed 64-bit hash. T must provide
+ * hash(), coeff() and an operator== that compares term keys
+ * (operators and variable), ignoring coefficients.
+ *
+ * Terms are stored contiguously as (hash, term) pairs in the
+ * order they were inserted, and a power-of-two, linearly
+ * probed index table maps hashes to positions in that array.
+ * Erasing a term back-shifts the probe sequence that follows
+ * it and moves the last term into its place, so the table
+ * never accumulates tombstones.
+ */
+template<typename T>
+class TermMap {
+
+public:
+
+	using value_type = std::pair<std::uint64_t, T>;
+	using iterator = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+protected:
+
+	/**
+	 * The terms, as (hash, term) pairs.
+	 */
+	std::vector<value_type> entries;
+
+	/**
+	 * The probe table, 0 for an empty slot, otherwise one
+	 * plus the position of the term in entries.
+	 */
+	std::vector<std::uint32_t> slots;
+
+	static std::uint64_t keyHash(const T& t) {
+		return t.hash();
+	}
+
+	std::size_t mask() const {
+		return slots.size() - 1;
+	}
+
+	/**
+	 * Return the slot holding the given term, or the
+	 * empty slot that ends its probe sequence.
+	 */
+	std::size_t probe(const std::uint64_t h, const T& t) const {
+		auto i = h & mask();
+		while (slots[i]) {
+			auto& e = entries[slots[i] - 1];
+			if (e.first == h && e.second == t) {
+				break;
+			}
+			i = (i + 1) & mask();
+		}
+		return i;
+	}
+
+	/**
+	 * Return the slot that points at the given entry.
+	 */
+	std::size_t slotOf(const std::uint32_t entry) const {
+		auto i = entries[entry].first & mask();
+		while (slots[i] != entry + 1) {
+			i = (i + 1) & mask();
+		}
+		return i;
+	}
+
+	void rehash(std::size_t capacity) {
+		std::size_t n = 16;
+		while (n < capacity) {
+			n <<= 1;
+		}
+
+		slots.assign(n, 0);
+		for (std::uint32_t e = 0; e < entries.size(); e++) {
+			auto i = entries[e].first & mask();
+			while (slots[i]) {
+				i = (i + 1) & mask();
+			}
+			slots[i] = e + 1;
+		}
+	}
+
+	/**
+	 * Make room for one more term, keeping the load
+	 * factor below 0.7.
+	 */
+	void grow() {
+		if (10 * (entries.size() + 1) > 7 * slots.size()) {
+			rehash(slots.empty() ? 16 : 2 * slots.size());
+		}
+	}
+
+	/**
+	 * Remove the term referenced by slot i.
+	 */
+	void eraseSlot(std::size_t i) {
+		auto entry = slots[i] - 1;
+
+		// Shift back any later members of this probe
+		// sequence that can now sit closer to their home slot
+		auto j = i;
+		while (true) {
+			j = (j + 1) & mask();
+			if (!slots[j]) {
+				break;
+			}
+			auto home = entries[slots[j] - 1].first & mask();
+			bool between = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+			if (!between) {
+				slots[i] = slots[j];
+				i = j;
+			}
+		}
+		slots[i] = 0;
+
+		// Fill the hole in entries with the last term
+		auto last = entries.size() - 1;
+		if (entry != last) {
+			slots[slotOf(last)] = entry + 1;
+			entries[entry] = std::move(entries[last]);
+		}
+		entries.pop_back();
+	}
+
+public:
+
+	TermMap() {
+	}
+
+	std::size_t size() const {
+		return entries.size();
+	}
+
+	bool empty() const {
+		return entries.empty();
+	}
+
+	void clear() {
+		entries.clear();
+		slots.clear();
+	}
+
+	/**
+	 * Size the table so that n terms can be added
+	 * without rehashing. Storage grows at least
+	 * geometrically, so reserving ahead of every
+	 * addition stays amortized linear.
+	 *
+	 * @param n The expected number of terms
+	 */
+	void reserve(const std::size_t n) {
+		if (n > entries.capacity()) {
+			entries.reserve(std::max(n, 2 * entries.capacity()));
+		}
+		if (10 * n > 7 * slots.size()) {
+			rehash(10 * n / 7 + 1);
+		}
+	}
+
+	iterator begin() {
+		return entries.begin();
+	}
+
+	iterator end() {
+		return entries.end();
+	}
+
+	const_iterator begin() const {
+		return entries.begin();
+	}
+
+	const_iterator end() const {
+		return entries.end();
+	}
+
+	/**
+	 * Return a pointer to the contiguous (hash, term) pairs.
+	 */
+	const value_type* data() const {
+		return entries.data();
+	}
+
+	/**
+	 * Return the term with the same key as t, or end().
+	 *
+	 * @param t The term to look up
+	 * @return iter The iterator to the stored term
+	 */
+	iterator find(const T& t) {
+		if (entries.empty()) {
+			return end();
+		}
+		auto i = probe(keyHash(t), t);
+		return slots[i] ? entries.begin() + (slots[i] - 1) : end();
+	}
+
+	const_iterator find(const T& t) const {
+		if (entries.empty()) {
+			return end();
+		}
+		auto i = probe(keyHash(t), t);
+		return slots[i] ? entries.begin() + (slots[i] - 1) : end();
+	}
+
+	std::size_t count(const T& t) const {
+		return find(t) == end() ? 0 : 1;
+	}
+
+	/**
+	 * Insert the term t if no term with its key is
+	 * present, otherwise leave the map unchanged.
+	 *
+	 * @param t The term to insert
+	 * @return inserted True if t was inserted
+	 */
+	template<typename U>
+	bool insert(U&& t) {
+		grow();
+		auto h = keyHash(t);
+		auto i = probe(h, t);
+		if (slots[i]) {
+			return false;
+		}
+		entries.emplace_back(h, std::forward<U>(t));
+		slots[i] = entries.size();
+		return true;
+	}
+
+	/**
+	 * Add the coefficient of t to the term with the
+	 * same key, inserting t if there is none. A term
+	 * whose coefficient falls below tol is removed.
+	 *
+	 * @param t The term to add
+	 * @param tol The magnitude below which terms are dropped
+	 */
+	template<typename U>
+	void accumulate(U&& t, const double tol) {
+		accumulate(keyHash(t), std::forward<U>(t), tol);
+	}
+
+	/**
+	 * Accumulate the term t, whose hash h has
+	 * already been computed.
+	 *
+	 * @param h The hash of t
+	 * @param t The term to add
+	 * @param tol The magnitude below which terms are dropped
+	 */
+	template<typename U>
+	void accumulate(const std::uint64_t h, U&& t, const double tol) {
+		grow();
+		auto i = probe(h, t);
+		if (slots[i]) {
+			auto& c = entries[slots[i] - 1].second.coeff();
+			c += t.coeff();
+			if (std::abs(c) < tol) {
+				eraseSlot(i);
+			}
+		} else if (std::abs(t.coeff()) >= tol) {
+			entries.emplace_back(h, std::forward<U>(t));
+			slots[i] = entries.size();
+		}
+	}
+
+	/**
+	 * Accumulate every term of other into this map,
+	 * reusing the hashes other has already computed.
+	 *
+	 * @param other The map to merge, left in an unspecified state
+	 * @param tol The magnitude below which terms are dropped
+	 */
+	void merge(TermMap&& other, const double tol) {
+		if (entries.empty()) {
+			*this = std::move(other);
+			return;
+		}
+		reserve(entries.size() + other.size());
+		for (auto& e : other.entries) {
+			accumulate(e.first, std::move(e.second), tol);
+		}
+		other.clear();
+	}
+
+	/**
+	 * Build a map from (hash, term) pairs whose keys are
+	 * distinct, keeping their order.
+	 *
+	 * @param pairs The pairs to take ownership of
+	 * @return result The new map
+	 */
+	static TermMap fromEntries(std::vector<value_type>&& pairs) {
+		TermMap result;
+		result.entries = std::move(pairs);
+		result.rehash(10 * result.entries.size() / 7 + 1);
+		return result;
+	}
+
+	/**
+	 * Concatenate maps whose keys are pairwise disjoint,
+	 * moving their terms without any key comparisons.
+	 *
+	 * @param maps The maps to join, left empty
+	 * @return result The concatenated map
+	 */
+	static TermMap concat(std::vector<TermMap>& maps) {
+		std::size_t n = 0;
+		for (auto& m : maps) {
+			n += m.size();
+		}
+
+		std::vector<value_type> pairs;
+		pairs.reserve(n);
+		for (auto& m : maps) {
+			std::move(m.entries.begin(), m.entries.end(),
+					std::back_inserter(pairs));
+			m.clear();
+		}
+		return fromEntries(std::move(pairs));
+	}
+
+	/**
+	 * Reorder the terms so that iteration follows the
+	 * given strict weak ordering on terms.
+	 *
+	 * @param less The term comparison
+	 */
+	template<typename Compare>
+	void sort(Compare less) {
+		std::sort(entries.begin(), entries.end(),
+				[&](const value_type& a, const value_type& b) {
+					return less(a.second, b.second);
+				});
+		rehash(slots.size());
+	}
+
+	/**
+	 * Remove the term with the same key as t.
+	 *
+	 * @param t The term to remove
+	 * @return erased The number of terms removed
+	 */
+	std::size_t erase(const T& t) {
+		if (entries.empty()) {
+			return 0;
+		}
+		auto i = probe(keyHash(t), t);
+		if (!slots[i]) {
+			return 0;
+		}
+		eraseSlot(i);
+		return 1;
+	}
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include "TransformationCache.hpp"
+#include "MappedPauliOperator.hpp"
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace xacc {
+namespace vqe {
+
+namespace {
+
+/**
+ * Two independent 64-bit FNV-1a streams, giving a 128-bit key.
+ */
+class KeyHasher {
+	std::uint64_t h1 = 0xcbf29ce484222325ULL;
+	std::uint64_t h2 = 0x84222325cbf29ce4ULL;
+
+public:
+
+	void add(const void* data, const std::size_t n) {
+		auto bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < n; i++) {
+			h1 = (h1 ^ bytes[i]) * 0x100000001b3ULL;
+			h2 = (h2 ^ bytes[i]) * 0x100000001b3ULL;
+			h2 ^= h2 >> 29;
+		}
+	}
+
+	template<typename T>
+	void add(const T& value) {
+		add(&value, sizeof(T));
+	}
+
+	void add(const std::string& s) {
+		add(s.size());
+		add(s.data(), s.size());
+	}
+
+	std::string hex() const {
+		std::stringstream ss;
+		ss << std::hex << std::setfill('0') << std::setw(16) << h1
+				<< std::setw(16) << h2;
+		return ss.str();
+	}
+};
+
+/**
+ * A fermion term as (site, creation) pairs, coefficient and variable.
+ */
+using CanonicalTerm = std::tuple<std::vector<std::pair<int, int>>, double, double,
+		std::string>;
+
+}
+
+TransformationCache::TransformationCache(const std::string& dir,
+		const std::uint64_t maxSize) :
+		directory(dir), maxBytes(maxSize) {
+	boost::system::error_code ec;
+	fs::create_directories(directory, ec);
+	if (!fs::is_directory(directory)) {
+		xacc::error("Could not create transformation cache directory "
+				+ directory + ".");
+	}
+}
+
+std::shared_ptr<TransformationCache> TransformationCache::fromOptions() {
+	if (!xacc::optionExists("fermion-cache-dir")) {
+		return nullptr;
+	}
+
+	// The limit is given in megabytes, default 1 GB
+	std::uint64_t maxMB = 1024;
+	if (xacc::optionExists("fermion-cache-size")) {
+		maxMB = std::stoull(xacc::getOption("fermion-cache-size"));
+	}
+	return std::make_shared<TransformationCache>(
+			xacc::getOption("fermion-cache-dir"), maxMB << 20);
+}
+
+std::string TransformationCache::key(FermionKernel& kernel,
+		const std::string& transformation, const int nQubits) {
+	auto& fermions = kernel.getOperator();
+	std::vector<CanonicalTerm> terms;
+	terms.reserve(fermions.nTerms());
+	for (std::size_t i = 0; i < fermions.nTerms(); i++) {
+		auto& coeff = fermions.coeff(i);
+		terms.emplace_back(fermions.operators(i), std::real(coeff),
+				std::imag(coeff), fermions.var(i));
+	}
+	std::sort(terms.begin(), terms.end());
+
+	KeyHasher hasher;
+	hasher.add(std::string("xacc-vqe-transformation-v1"));
+	hasher.add(transformation);
+	hasher.add(nQubits);
+	hasher.add(terms.size());
+	for (auto& t : terms) {
+		auto& ops = std::get<0>(t);
+		hasher.add(ops.size());
+		for (auto& op : ops) {
+			hasher.add(op.first);
+			hasher.add(op.second);
+		}
+		hasher.add(std::get<1>(t));
+		hasher.add(std::get<2>(t));
+		hasher.add(std::get<3>(t));
+	}
+	return hasher.hex();
+}
+
+bool TransformationCache::lookup(const std::string& key,
+		PauliOperator& result) {
+	auto path = fs::path(directory) / (key + ".pauli");
+	boost::system::error_code ec;
+	if (!fs::exists(path, ec)) {
+		return false;
+	}
+
+	// A corrupt or stale entry is just a miss
+	if (!MappedPauliOperator::tryLoad(path.string(), result)) {
+		fs::remove(path, ec);
+		return false;
+	}
+
+	// Mark the entry as recently used
+	fs::last_write_time(path, std::time(nullptr), ec);
+	return true;
+}
+
+void TransformationCache::store(const std::string& key,
+		const PauliOperator& result) {
+	// Write to a private file and rename it into place, so concurrent
+	// runs never see a partial entry
+	auto path = fs::path(directory) / (key + ".pauli");
+	auto tmp = fs::path(directory) / fs::unique_path(key + "-%%%%%%%%.tmp");
+	result.save(tmp.string());
+
+	boost::system::error_code ec;
+	fs::rename(tmp, path, ec);
+	if (ec) {
+		fs::remove(tmp, ec);
+		return;
+	}
+	evict();
+}
+
+void TransformationCache::evict() {
+	std::vector<std::tuple<std::time_t, std::uint64_t, fs::path>> entries;
+	std::uint64_t total = 0;
+	boost::system::error_code ec;
+	for (fs::directory_iterator it(directory, ec), end; it != end; it.increment(ec)) {
+		auto& p = it->path();
+		if (p.extension() != ".pauli") {
+			continue;
+		}
+		auto size = fs::file_size(p, ec);
+		if (ec) {
+			continue;
+		}
+		entries.emplace_back(fs::last_write_time(p, ec), size, p);
+		total += size;
+	}
+
+	std::sort(entries.begin(), entries.end());
+	for (auto& e : entries) {
+		if (total <= maxBytes) {
+			break;
+		}
+		fs::remove(std::get<2>(e), ec);
+		total -= std::get<1>(e);
+	}
+}
+
+}
+}
@@ -0,0 +1,113 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_TRANSFORMATIONCACHE_HPP_
+#define VQE_IR_TRANSFORMATIONCACHE_HPP_
+
+#include "FermionKernel.hpp"
+#include "PauliOperator.hpp"
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The TransformationCache is a content-addressed, on-disk store
+ * of fermion to spin transformation results. Entries are keyed
+ * by a hash of the canonicalized fermion terms, the transformation
+ * name and the number of qubits, and hold the resulting
+ * PauliOperator in the binary format of PauliOperator::save().
+ *
+ * When the cache grows past its size limit the least recently
+ * used entries are removed.
+ */
+class TransformationCache {
+
+protected:
+
+	std::string directory;
+
+	std::uint64_t maxBytes;
+
+	void evict();
+
+public:
+
+	/**
+	 * The constructor, takes the cache directory, created if
+	 * needed, and the maximum total size of its entries.
+	 *
+	 * @param dir The cache directory
+	 * @param maxSize The size limit in bytes
+	 */
+	TransformationCache(const std::string& dir, const std::uint64_t maxSize);
+
+	/**
+	 * Return the cache configured by the fermion-cache-dir and
+	 * fermion-cache-size options, or nullptr if caching is off.
+	 */
+	static std::shared_ptr<TransformationCache> fromOptions();
+
+	/**
+	 * Return the key of the given transformation of kernel. The
+	 * key does not depend on the order of the fermion terms.
+	 *
+	 * @param kernel The fermion kernel
+	 * @param transformation The transformation's cacheKey, its name
+	 * and the parameters its result depends on
+	 * @param nQubits The number of qubits
+	 * @return key The hex encoded 128-bit key
+	 */
+	static std::string key(FermionKernel& kernel,
+			const std::string& transformation, const int nQubits);
+
+	/**
+	 * Load the entry with the given key into result.
+	 *
+	 * @return hit True if the entry was found
+	 */
+	bool lookup(const std::string& key, PauliOperator& result);
+
+	/**
+	 * Store result under the given key, evicting old entries
+	 * if the cache is over its size limit.
+	 */
+	void store(const std::string& key, const PauliOperator& result);
+
+	const std::string& getDirectory() const {
+		return directory;
+	}
+};
+
+}
+
+}
+
+#endif
@@ -13,6 +13,12 @@ namespace vqe {
 std::shared_ptr<Function> UCCSD::generate(
 		std::shared_ptr<AcceleratorBuffer> buffer,
 		std::vector<InstructionParameter> parameters) {
+	return generate(buffer, std::vector<int> { });
+}
+
+std::shared_ptr<Function> UCCSD::generate(
+		std::shared_ptr<AcceleratorBuffer> buffer,
+		const std::vector<int>& permutation, const QubitTapering& tapering) {
 
 	auto runtimeOptions = RuntimeOptions::instance();
 
@@ -56,27 +62,18 @@ std::shared_ptr<Function> UCCSD::generate(
 	}
 
 	auto kernel = std::make_shared<FermionKernel>("fermiUCCSD");
+	auto& fermions = kernel->getOperator();
 	xacc::info("Constructing UCCSD Fermion Operator.");
 	for (int i = 0; i < _nVirtual; i++) {
 		for (int j = 0; j < _nOccupied; j++) {
 			for (int l = 0; l < 2; l++) {
 				std::vector<std::pair<int, int>> operators { { 2
 						* (i + _nOccupied) + l, 1 }, { 2 * j + l, 0 } };
-				auto fermiInstruction1 = std::make_shared<FermionInstruction>(
-						operators, params[singletIndex(i, j)]);
-				kernel->addInstruction(fermiInstruction1);
+				fermions.addTerm(operators, 1.0, params[singletIndex(i, j)]);
 
 				std::vector<std::pair<int, int>> operators2 { { 2 * j + l, 1 },
 						{ 2 * (i + _nOccupied) + l, 0 } };
-				auto fermiInstruction2 = std::make_shared<FermionInstruction>(
-						operators2, params[singletIndex(i, j)]);
-
-
-				auto nP = fermiInstruction2->nParameters();
-				InstructionParameter p(-1.0*std::complex<double>(1,0));
-				fermiInstruction2->setParameter(nP-2,p);
-
-				kernel->addInstruction(fermiInstruction2);
+				fermions.addTerm(operators2, -1.0, params[singletIndex(i, j)]);
 
 			}
 		}
@@ -103,20 +100,8 @@ std::shared_ptr<Function> UCCSD::generate(
 							auto doubletIdx2 = nSingle
 									+ doubletIndex(i, j, i2, j2);
 
-							auto fermiInstruction1 = std::make_shared<
-									FermionInstruction>(operators1,
-									params[doubletIdx1]);
-
-							kernel->addInstruction(fermiInstruction1);
-
-							auto fermiInstruction2 = std::make_shared<
-									FermionInstruction>(operators2,
-									params[doubletIdx2]);
-
-							auto nP = fermiInstruction2->nParameters();
-							InstructionParameter p(-1.0*std::complex<double>(1,0));
-							fermiInstruction2->setParameter(nP-2,p);
-							kernel->addInstruction(fermiInstruction2);
+							fermions.addTerm(operators1, 1.0, params[doubletIdx1]);
+							fermions.addTerm(operators2, -1.0, params[doubletIdx2]);
 
 						}
 					}
@@ -125,6 +110,11 @@ std::shared_ptr<Function> UCCSD::generate(
 		}
 	}
 
+	// Act on the qubits the compiler placed the modes on
+	if (!permutation.empty()) {
+		fermions.permuteSites(permutation);
+	}
+
 //	std::cout << "KERNEL: \n" << kernel->toString("") << "\n";
 	// Create the FermionIR to pass to our transformation.
 	auto fermionir = std::make_shared<FermionIR>();
@@ -144,6 +134,15 @@ std::shared_ptr<Function> UCCSD::generate(
 	}
 
 	auto compositeResult = transform->transform(*kernel.get());
+
+	// Act on the qubits left by the Hamiltonian's tapering. Terms
+	// that anticommute with a symmetry, like the single excitations
+	// breaking a spatial symmetry of H2, would leave the reference's
+	// sector, where the ground state lies, so they are dropped
+	if (tapering.nSymmetries()) {
+		compositeResult = tapering.taper(
+				tapering.commutingTerms(compositeResult));
+	}
 //	auto resultsStr = compositeResult.toString();
 //	boost::replace_all(resultsStr, "+", "+\n");
 
@@ -151,10 +150,9 @@ std::shared_ptr<Function> UCCSD::generate(
 	auto transformedIR = compositeResult.toXACCIR();
 	xacc::info("Done mapping UCCSD Fermion Operator to Spin.");
 
-	std::unordered_map<std::string, Term> terms = compositeResult.getTerms();
-
 	CommutingSetGenerator gen;
-	auto commutingSets = gen.getCommutingSet(compositeResult, nQubits);
+	auto commutingSets = gen.getCommutingSet(compositeResult,
+			tapering.nSymmetries() ? tapering.nReducedQubits() : nQubits);
 	auto pi = boost::math::constants::pi<double>();
 	auto gateRegistry = xacc::getService<IRProvider>("gate");
 
@@ -165,17 +163,16 @@ std::shared_ptr<Function> UCCSD::generate(
 	// Perform Trotterization...
 	for (auto s : commutingSets) {
 
-		for (auto inst : s) {
-			Term spinInst = inst;
+		for (auto& spinInst : s) {
 
 			// Get the individual pauli terms
-			auto termsMap = std::get<2>(spinInst);
-
 			std::vector<std::pair<int,std::string>> terms;
-			for (auto& kv : termsMap) {
-				if (kv.second != "I" && !kv.second.empty()) {
-					terms.push_back({kv.first, kv.second});
-				}
+			spinInst.pauliString().forEachOp([&](const int q, const char op) {
+				terms.push_back({q, std::string(1, op)});
+			});
+			// Tapering may leave a global phase
+			if (terms.empty()) {
+				continue;
 			}
 			// The largest qubit index is on the last term
 			int largestQbitIdx = terms[terms.size() - 1].first;
@@ -266,8 +263,15 @@ std::shared_ptr<Function> UCCSD::generate(
 	}
 
 	for (int i = nElectrons-1; i >= 0; i--) {
+		auto q = permutation.empty() ? i : permutation[i];
+		if (tapering.nSymmetries()) {
+			q = tapering.reducedQubit(q);
+			if (q < 0) {
+				continue;
+			}
+		}
 		auto xGate = gateRegistry->createInstruction(
-				"X", std::vector<int>{i});
+				"X", std::vector<int>{q});
 		uccsdGateFunction->insertInstruction(0,xGate);
 	}
 
@@ -35,6 +35,7 @@
 #include "FermionKernel.hpp"
 #include "FermionIR.hpp"
 #include "PauliOperator.hpp"
+#include "QubitTapering.hpp"
 
 namespace xacc {
 
@@ -61,6 +62,21 @@ public:
 			std::vector<InstructionParameter> parameters = std::vector<
 					InstructionParameter> { });
 
+	/**
+	 * Generate the UCCSD ansatz for a Hamiltonian whose modes were
+	 * reordered, acting on qubit permutation[m] for mode m, and
+	 * whose qubits were tapered.
+	 *
+	 * @param buffer The bits this algorithm operates on
+	 * @param permutation The qubit of each mode, or empty
+	 * @param tapering The tapering of the Hamiltonian's qubits
+	 * @return function The algorithm represented as an IR Function
+	 */
+	std::shared_ptr<Function> generate(
+			std::shared_ptr<AcceleratorBuffer> buffer,
+			const std::vector<int>& permutation,
+			const QubitTapering& tapering = QubitTapering());
+
 
 	virtual const std::string name() const {
 		return "uccsd";
@@ -0,0 +1,108 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include "PauliOperator.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace xacc::vqe;
+
+namespace {
+
+std::mt19937 gen(42);
+
+PauliOperator randomOp(const int nTerms, const int nQubits) {
+	std::uniform_int_distribution<int> pauli(0, 3);
+	std::uniform_real_distribution<double> coeff(-1.0, 1.0);
+	PauliOperator op;
+	for (int i = 0; i < nTerms; i++) {
+		PauliString p;
+		for (int q = 0; q < nQubits; q++) {
+			p.set(q, "IXYZ"[pauli(gen)]);
+		}
+		op.addTerm(Term(coeff(gen), "", p));
+	}
+	return op;
+}
+
+template<typename F>
+double time(F f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+/**
+ * Time PauliOperator products and sums serially and threaded,
+ * xacc-vqe-pauli-benchmark [nThreads].
+ */
+int main(int argc, char** argv) {
+	auto nThreads = argc > 1 ? std::atoi(argv[1]) : 4;
+
+	auto a = randomOp(300, 12), b = randomOp(300, 12);
+	auto big = randomOp(1 << 17, 24);
+	std::vector<PauliOperator> small;
+	for (int i = 0; i < 1000; i++) {
+		small.push_back(randomOp(1, 24));
+	}
+
+	for (auto n : { 1, nThreads }) {
+		PauliOperator::setNumThreads(n);
+
+		PauliOperator product;
+		auto productTime = time([&]() {
+			product = a * b;
+		});
+
+		PauliOperator sum;
+		auto sumTime = time([&]() {
+			sum = big + big;
+		});
+
+		PauliOperator accumulated = big;
+		auto accumulateTime = time([&]() {
+			for (auto& s : small) {
+				accumulated += s;
+			}
+		});
+
+		std::cout << n << " threads: " << a.nTerms() << " x " << b.nTerms()
+				<< " product " << productTime << " s, " << big.nTerms()
+				<< " term sum " << sumTime << " s, " << small.size()
+				<< " single term additions " << accumulateTime << " s\n";
+	}
+
+	return 0;
+}
@@ -31,6 +31,9 @@
  **********************************************************************************/
 #include <gtest/gtest.h>
 #include "FermionKernel.hpp"
+#include "ModeOrdering.hpp"
+#include "ExpectXACCError.hpp"
+#include <random>
 
 using namespace xacc::vqe;
 
@@ -53,14 +56,268 @@ TEST(FermionKernelTester,checkFermionKernelConstruction) {
 
 	EXPECT_TRUE(kernel.nInstructions() == 3);
 	EXPECT_TRUE(kernel.name() == "foo");
-	EXPECT_TRUE(kernel.getInstruction(0) == Instruction);
-	EXPECT_TRUE(kernel.getInstruction(1) == Instruction2);
-	EXPECT_TRUE(kernel.getInstruction(2) == Instruction3);
+	// The kernel stores terms, so instructions come back as copies
+	EXPECT_EQ(kernel.getInstruction(0)->toString(""), Instruction->toString(""));
+	EXPECT_EQ(kernel.getInstruction(1)->toString(""), Instruction2->toString(""));
+	EXPECT_EQ(kernel.getInstruction(2)->toString(""), Instruction3->toString(""));
 
 	std::cout << kernel.toString("") << "\n";
 
 }
 
+TEST(FermionKernelTester,checkFermionOperator) {
+
+	FermionKernel kernel("foo");
+	auto& op = kernel.getOperator();
+	op.addTerm({ { 3, 1 }, { 1, 0 } }, 0.5, "theta");
+	op.addTerm({ { 4, 1 }, { 3, 1 }, { 9, 0 }, { 1, 0 } }, std::complex<double>(0, 2));
+	op.addTerm({ }, 0.7);
+
+	EXPECT_EQ(3, kernel.nInstructions());
+	EXPECT_EQ(4, op.nOperators(1));
+	EXPECT_EQ(9, op.site(1, 2));
+	EXPECT_EQ(3, op.creationMask(1));
+	EXPECT_TRUE(op.isCreation(0, 0));
+	EXPECT_FALSE(op.isCreation(0, 1));
+	EXPECT_EQ("theta", op.var(0));
+	EXPECT_EQ("", op.var(1));
+	EXPECT_EQ(9, op.maxSite());
+	EXPECT_EQ(0.7, kernel.E_nuc());
+	EXPECT_EQ(std::complex<double>(0.5, 0), kernel.hpq(10)(3, 1));
+	EXPECT_EQ(std::complex<double>(0, 2), kernel.hpqrs(10)(4, 3, 9, 1));
+
+	// Instructions round trip through the flat storage
+	auto inst = kernel.getInstruction(0);
+	EXPECT_EQ((std::vector<int> { 3, 1 }), inst->bits());
+	EXPECT_EQ("theta", boost::get<std::string>(inst->getParameter(3)));
+
+	kernel.insertInstruction(1, std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 2, 1 }, { 2, 0 } }, 1.5));
+	EXPECT_EQ(4, kernel.nInstructions());
+	EXPECT_EQ(2, op.site(1, 0));
+	EXPECT_EQ(9, op.site(2, 2));
+
+	kernel.removeInstruction(0);
+	EXPECT_EQ(3, kernel.nInstructions());
+	EXPECT_EQ(std::complex<double>(1.5, 0), op.coeff(0));
+	EXPECT_EQ(4, op.site(1, 0));
+
+	kernel.replaceInstruction(1, std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 5, 0 } }, "phi"));
+	EXPECT_EQ(1, op.nOperators(1));
+	EXPECT_EQ(5, op.site(1, 0));
+	EXPECT_EQ("phi", op.var(1));
+	EXPECT_EQ(0, op.nOperators(2));
+	EXPECT_XACC_ERROR(kernel.getInstruction(3));
+}
+
+TEST(FermionKernelTester,checkIntegralStore) {
+
+	// Random real integrals over 3 spatial orbitals with
+	// the 8-fold symmetry of (pq|rs)
+	const int n = 3;
+	std::mt19937 gen(7);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	double h[n][n], g[n][n][n][n];
+	for (int p = 0; p < n; p++) {
+		for (int q = 0; q <= p; q++) {
+			h[p][q] = h[q][p] = dist(gen);
+		}
+	}
+	for (int p = 0; p < n; p++) {
+		for (int q = 0; q <= p; q++) {
+			for (int r = 0; r < n; r++) {
+				for (int s = 0; s <= r; s++) {
+					if (p * (p + 1) / 2 + q < r * (r + 1) / 2 + s) {
+						continue;
+					}
+					auto v = dist(gen);
+					g[p][q][r][s] = g[q][p][r][s] = g[p][q][s][r] = g[q][p][s][r] = v;
+					g[r][s][p][q] = g[s][r][p][q] = g[r][s][q][p] = g[s][r][q][p] = v;
+				}
+			}
+		}
+	}
+
+	// Expand to interleaved spin orbitals as every term of
+	// a molecular Hamiltonian
+	FermionKernel kernel("h");
+	auto& op = kernel.getOperator();
+	op.addTerm({ }, 0.25);
+	for (int P = 0; P < 2 * n; P++) {
+		for (int Q = 0; Q < 2 * n; Q++) {
+			if (P % 2 == Q % 2) {
+				op.addTerm({ { P, 1 }, { Q, 0 } }, h[P / 2][Q / 2]);
+			}
+			for (int R = 0; R < 2 * n; R++) {
+				for (int S = 0; S < 2 * n; S++) {
+					if (P % 2 == S % 2 && Q % 2 == R % 2) {
+						op.addTerm({ { P, 1 }, { Q, 1 }, { R, 0 }, { S, 0 } },
+								0.5 * g[P / 2][S / 2][Q / 2][R / 2]);
+					}
+				}
+			}
+		}
+	}
+	// One term that breaks the symmetry is kept as given
+	op.addTerm({ { 0, 1 }, { 3, 1 }, { 4, 0 }, { 2, 0 } }, std::complex<double>(0, 2));
+
+	auto store = kernel.integrals();
+	EXPECT_EQ(n, store->nSpatialOrbitals());
+	EXPECT_EQ(6, store->getOneBodyIntegrals().size());
+	EXPECT_EQ(21, store->getTwoBodyIntegrals().size());
+	EXPECT_EQ(0.25, kernel.E_nuc());
+	EXPECT_EQ(store.get(), kernel.integrals().get());
+
+	std::size_t nBlocked = 0;
+	for (int p = 0; p < n; p++) {
+		for (int q = 0; q <= p; q++) {
+			for (auto& e : store->block(p, q)) {
+				EXPECT_EQ(p, e.p);
+				EXPECT_EQ(q, e.q);
+				EXPECT_EQ(g[p][q][e.r][e.s], e.value);
+				nBlocked++;
+			}
+		}
+	}
+	EXPECT_EQ(21, nBlocked);
+
+	auto hpq = kernel.hpq(2 * n);
+	auto hpqrs = kernel.hpqrs(2 * n);
+	auto dense = hpqrs.toTensor();
+	for (int i = 0; i < op.nTerms(); i++) {
+		auto s = op.sites(i);
+		if (op.nOperators(i) == 2) {
+			EXPECT_EQ(op.coeff(i), hpq(s[0], s[1]));
+		} else if (op.nOperators(i) == 4) {
+			EXPECT_NEAR(0.0, std::abs(op.coeff(i) - hpqrs(s[0], s[1], s[2], s[3])), 1e-12);
+			EXPECT_NEAR(0.0, std::abs(op.coeff(i) - dense(s[0], s[1], s[2], s[3])), 1e-12);
+		}
+	}
+	EXPECT_EQ(0.0, hpq(0, 1));
+	EXPECT_EQ(0.0, hpqrs(0, 1, 0, 1));
+	EXPECT_EQ(0.0, hpqrs(0, 1, 2, 2 * n));
+
+	// Integrals given at only some of their orders are not
+	// completed by symmetry
+	FermionOperator partial;
+	partial.addTerm({ { 2, 1 }, { 0, 0 } }, 0.5);
+	partial.addTerm({ { 1, 1 }, { 1, 0 } }, 0.25);
+	partial.addTerm({ { 0, 1 }, { 3, 1 }, { 5, 0 }, { 2, 0 } }, 0.125);
+	IntegralStore partialStore(partial);
+	EXPECT_TRUE(partialStore.getOneBodyIntegrals().empty());
+	EXPECT_TRUE(partialStore.getTwoBodyIntegrals().empty());
+	EXPECT_EQ(0.5, partialStore.hpq(2, 0));
+	EXPECT_EQ(0.0, partialStore.hpq(0, 2));
+	EXPECT_EQ(0.25, partialStore.hpq(1, 1));
+	EXPECT_EQ(0.0, partialStore.hpq(0, 0));
+	EXPECT_EQ(0.125, partialStore.hpqrs(0, 3, 5, 2));
+	EXPECT_EQ(0.0, partialStore.hpqrs(3, 0, 2, 5));
+	FermionOperator expanded;
+	partialStore.expand(expanded);
+	EXPECT_EQ(3, expanded.nTerms());
+}
+
+TEST(FermionKernelTester,checkNormalOrder) {
+
+	FermionOperator op;
+	op.addTerm( { { 1, 1 }, { 0, 0 } }, 1.0);
+	op.addTerm( { { 0, 0 }, { 1, 1 } }, 0.5);
+	op.addTerm( { { 0, 1 }, { 1, 0 } }, 0.25);
+	op.addTerm( { { 1, 1 }, { 0, 0 } }, 3.0, "theta");
+	op.addTerm( { { 0, 0 }, { 0, 1 } }, 2.0);
+	op.addTerm( { { 2, 1 }, { 2, 1 } }, 5.0);
+	op.addTerm( { { 1, 1 }, { 0, 1 }, { 0, 0 }, { 1, 0 } }, 1.0);
+	op.addTerm( { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } }, 1.0);
+
+	auto find = [](const FermionOperator& f,
+			const std::vector<std::pair<int, int>>& ops,
+			const std::string& var) -> int {
+		for (int i = 0; i < f.nTerms(); i++) {
+			if (f.nOperators(i) != ops.size() || f.var(i) != var) {
+				continue;
+			}
+			bool match = true;
+			for (int k = 0; k < ops.size(); k++) {
+				match = match && f.site(i, k) == ops[k].first
+						&& f.isCreation(i, k) == bool(ops[k].second);
+			}
+			if (match) {
+				return i;
+			}
+		}
+		return -1;
+	};
+
+	auto ordered = op.normalOrdered();
+	EXPECT_EQ(6, ordered.nTerms());
+	EXPECT_EQ(0.5, ordered.coeff(find(ordered, { { 1, 1 }, { 0, 0 } }, "")));
+	EXPECT_EQ(0.25, ordered.coeff(find(ordered, { { 0, 1 }, { 1, 0 } }, "")));
+	EXPECT_EQ(3.0, ordered.coeff(find(ordered, { { 1, 1 }, { 0, 0 } }, "theta")));
+	EXPECT_EQ(2.0, ordered.coeff(find(ordered, { }, "")));
+	EXPECT_EQ(-2.0, ordered.coeff(find(ordered, { { 0, 1 }, { 0, 0 } }, "")));
+	EXPECT_EQ(-2.0, ordered.coeff(find(ordered,
+			{ { 1, 1 }, { 0, 1 }, { 1, 0 }, { 0, 0 } }, "")));
+
+	// a_0^+ a_1 is the adjoint of a_1^+ a_0 and folds into it
+	std::vector<std::complex<double>> conjugates;
+	auto folded = op.normalOrdered(&conjugates);
+	EXPECT_EQ(5, folded.nTerms());
+	EXPECT_EQ(5, conjugates.size());
+	EXPECT_EQ(-1, find(folded, { { 0, 1 }, { 1, 0 } }, ""));
+	auto i = find(folded, { { 1, 1 }, { 0, 0 } }, "");
+	EXPECT_EQ(0.5, folded.coeff(i));
+	EXPECT_EQ(0.25, conjugates[i]);
+	EXPECT_EQ(0.0, conjugates[find(folded, { { 1, 1 }, { 0, 0 } }, "theta")]);
+	EXPECT_EQ(0.0, conjugates[find(folded, { { 0, 1 }, { 0, 0 } }, "")]);
+
+	// Terms cancelling exactly are dropped
+	FermionOperator cancel;
+	cancel.addTerm( { { 1, 1 }, { 0, 0 } }, 1.0);
+	cancel.addTerm( { { 0, 0 }, { 1, 1 } }, 1.0);
+	EXPECT_EQ(0, cancel.normalOrdered().nTerms());
+}
+
+TEST(FermionKernelTester,checkModeOrdering) {
+
+	// A hopping chain through the modes in scrambled order, plus
+	// density terms that carry no strings
+	std::vector<int> chain { 0, 5, 2, 7, 1, 6, 3, 4 };
+	FermionOperator op;
+	for (int k = 0; k + 1 < chain.size(); k++) {
+		op.addTerm( { { chain[k], 1 }, { chain[k + 1], 0 } }, 1.0 + k);
+		op.addTerm( { { chain[k + 1], 1 }, { chain[k], 0 } }, 1.0 + k);
+	}
+	op.addTerm( { { 0, 1 }, { 7, 1 }, { 7, 0 }, { 0, 0 } }, 10.0);
+
+	ModeOrdering ordering(op, 8);
+	std::vector<int> identity { 0, 1, 2, 3, 4, 5, 6, 7 };
+	EXPECT_EQ(5, ordering.maxLength(identity));
+	EXPECT_NEAR(2 * (1 * 4 + 2 * 2 + 3 * 4 + 4 * 5 + 5 * 4 + 6 * 2 + 7 * 0),
+			ordering.totalLength(identity), 1e-12);
+
+	// Cuthill-McKee lays the chain out in a line
+	for (auto permutation : { ordering.cuthillMcKee(),
+			ordering.optimize(ModeOrdering::Objective::Total, false) }) {
+		EXPECT_EQ(0, ordering.maxLength(permutation));
+		EXPECT_EQ(0.0, ordering.totalLength(permutation));
+	}
+
+	// Local search never makes an ordering worse
+	std::vector<int> reversed { 7, 6, 5, 4, 3, 2, 1, 0 };
+	auto refined = ordering.refine(reversed, ModeOrdering::Objective::Total);
+	EXPECT_LT(ordering.totalLength(refined), ordering.totalLength(reversed));
+	refined = ordering.refine(reversed, ModeOrdering::Objective::Max);
+	EXPECT_LE(ordering.maxLength(refined), ordering.maxLength(reversed));
+
+	auto permutation = ordering.cuthillMcKee();
+	EXPECT_EQ(permutation, ModeOrdering::parse(ModeOrdering::toString(permutation)));
+	op.permuteSites(permutation);
+	EXPECT_EQ(permutation[chain[0]], op.site(0, 0));
+	EXPECT_EQ(permutation[chain[1]], op.site(0, 1));
+	EXPECT_EQ(0.0, ModeOrdering(op, 8).totalLength(identity));
+}
+
 int main(int argc, char** argv) {
    ::testing::InitGoogleTest(&argc, argv);
    return RUN_ALL_TESTS();
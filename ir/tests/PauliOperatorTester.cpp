@@ -30,9 +30,13 @@
  **********************************************************************************/
 #include <gtest/gtest.h>
 #include "PauliOperator.hpp"
+#include "MappedPauliOperator.hpp"
+#include "ExpectXACCError.hpp"
 #include <boost/algorithm/string.hpp>
 #include "XACC.hpp"
 #include "IRProvider.hpp"
+#include <random>
+#include <fstream>
 
 using namespace xacc::vqe;
 
@@ -146,7 +150,7 @@ TEST(PauliOperatorTester,checkVariableCoefficient) {
 	EXPECT_TRUE(i2 != inst);
 	auto sumInst = inst + i2;
 	std::cout << "SUMSTR: " << sumInst.toString() << "\n";
-	EXPECT_TRUE("(1,0) theta2 Z3 X4 + (1,0) theta Z3 X4" == sumInst.toString());
+	EXPECT_TRUE("(1,0) theta Z3 X4 + (1,0) theta2 Z3 X4" == sumInst.toString());
 }
 
 TEST(PauliOperatorTester,checkBinaryVector) {
@@ -338,6 +342,539 @@ TEST(PauliOperatorTester,checkComposition) {
 TEST(PauliOperatorTester,checkMatrixElements) {
 	PauliOperator op({{0, "X"}, {1, "Y"}, {2, "Z"}});
 	auto elements = op.getSparseMatrixElements();
+	EXPECT_EQ(8, elements.size());
+	for (auto& e : elements) {
+		auto sign = (e.row() >> 2) & 1 ? -1.0 : 1.0;
+		auto phase = (e.row() >> 1) & 1 ? std::complex<double>(0, 1) : std::complex<double>(0, -1);
+		EXPECT_EQ(e.row() ^ 3, e.col());
+		EXPECT_EQ(sign * phase, e.coeff());
+	}
+
+	// Terms reaching the same element are merged, X0 X1 - Y0 Y1
+	// only connecting |00> and |11>
+	PauliOperator hop({{0, "X"}, {1, "X"}}, 0.5);
+	hop -= PauliOperator({{0, "Y"}, {1, "Y"}}, 0.5);
+	hop += PauliOperator({{0, "Z"}});
+	auto csr = hop.getCSRMatrix(2);
+	EXPECT_EQ((std::vector<std::int64_t> {0, 2, 3, 4, 6}), csr.rowPtr);
+	EXPECT_EQ((std::vector<std::int64_t> {0, 3, 1, 2, 0, 3}), csr.colIdx);
+	EXPECT_EQ(std::complex<double>(1, 0), csr.values[1]);
+	EXPECT_EQ(std::complex<double>(-1, 0), csr.values[2]);
+	EXPECT_EQ(std::complex<double>(-1, 0), csr.values[5]);
+
+	// Restricting to a subspace drops the elements that leave it
+	auto sub = hop.getSparseMatrix(std::vector<std::uint64_t> {3, 0});
+	EXPECT_EQ(2, sub.rows());
+	EXPECT_EQ(4, sub.nonZeros());
+	EXPECT_EQ(std::complex<double>(-1, 0), sub.coeff(0, 0));
+	EXPECT_EQ(std::complex<double>(1, 0), sub.coeff(0, 1));
+	EXPECT_EQ(std::complex<double>(1, 0), sub.coeff(1, 1));
+}
+
+TEST(PauliOperatorTester,checkPauliString) {
+
+	std::complex<double> i(0,1);
+	std::map<std::string, std::pair<std::complex<double>, char>> products {
+		{"XY", {i, 'Z'}}, {"YX", {-i, 'Z'}}, {"YZ", {i, 'X'}},
+		{"ZY", {-i, 'X'}}, {"ZX", {i, 'Y'}}, {"XZ", {-i, 'Y'}},
+		{"XX", {1, 'I'}}, {"YY", {1, 'I'}}, {"ZZ", {1, 'I'}},
+		{"IX", {1, 'X'}}, {"IY", {1, 'Y'}}, {"IZ", {1, 'Z'}}
+	};
+
+	// Check the products on qubits in the first, second, and a heap-allocated word
+	static const std::complex<double> phases[] = {1, i, -1, -i};
+	for (int qubit : {3, 70, 200}) {
+		for (auto& kv : products) {
+			PauliString a, b, r;
+			a.set(qubit, kv.first[0]);
+			b.set(qubit, kv.first[1]);
+			auto k = PauliString::multiply(a, b, r);
+			EXPECT_EQ(kv.second.first, phases[k]);
+			EXPECT_EQ(kv.second.second, r.get(qubit));
+			EXPECT_EQ(r.isIdentity(), kv.second.second == 'I');
+		}
+	}
+
+	PauliString p1({{0,"X"}, {65,"Z"}, {130,"Y"}}), p2({{0,"Z"}, {65,"X"}});
+	EXPECT_TRUE(p1.commutes(p2));
+	EXPECT_FALSE(p1.commutes(PauliString({{130,"X"}})));
+	EXPECT_EQ(3, p1.weight());
+	EXPECT_EQ(130, p1.maxQubit());
+	EXPECT_TRUE(p1 == PauliString(p1.toMap()));
+	EXPECT_EQ(p1.hash(), PauliString(p1.toMap()).hash());
+
+	// Equal strings of different widths compare and hash equal
+	PauliString narrow({{1,"X"}}), wide({{1,"X"}, {100, "X"}});
+	PauliString r;
+	PauliString::multiply(wide, PauliString({{100,"X"}}), r);
+	EXPECT_TRUE(narrow == r);
+	EXPECT_EQ(narrow.hash(), r.hash());
+
+	PauliOperator op({{0,"X"}, {65,"Z"}, {130,"Y"}}, 2.0);
+	auto op2 = op * PauliOperator({{0,"Y"}, {130,"Z"}});
+	EXPECT_TRUE(PauliOperator({{0,"Z"}, {65,"Z"}, {130,"X"}}, -2.0).isClose(op2));
+}
+
+TEST(PauliOperatorTester,checkTermMap) {
+
+	TermMap<Term> map;
+	map.reserve(4);
+	for (int i = 0; i < 100; i++) {
+		EXPECT_TRUE(map.insert(Term(1.0, {{i, "X"}})));
+	}
+	EXPECT_FALSE(map.insert(Term(2.0, {{3, "X"}})));
+	EXPECT_TRUE(map.insert(Term(std::complex<double>(1.0), "theta", {{3, "X"}})));
+	EXPECT_EQ(101, map.size());
+
+	// Cancel every other term, the rest must stay reachable
+	for (int i = 0; i < 100; i += 2) {
+		map.accumulate(Term(-1.0, {{i, "X"}}), 1e-12);
+	}
+	EXPECT_EQ(51, map.size());
+	for (int i = 0; i < 100; i++) {
+		EXPECT_EQ(i % 2, map.count(Term({{i, "X"}})));
+	}
+	EXPECT_EQ(1, map.count(Term("theta", {{3, "X"}})));
+
+	map.accumulate(Term(2.0, {{1, "X"}}), 1e-12);
+	EXPECT_EQ(3.0, std::real(map.find(Term({{1, "X"}}))->second.coeff()));
+	EXPECT_EQ(1, map.erase(Term({{1, "X"}})));
+	EXPECT_EQ(0, map.erase(Term({{1, "X"}})));
+	EXPECT_EQ(50, map.size());
+
+	// X0 X1 + X1 X0 - 2 X0 X1 cancels entirely
+	PauliOperator op({{0, "X"}, {1, "X"}});
+	op += PauliOperator({{1, "X"}, {0, "X"}});
+	op -= PauliOperator({{0, "X"}, {1, "X"}}, 2.0);
+	EXPECT_EQ(0, op.nTerms());
+}
+
+TEST(PauliOperatorTester,checkParallelProduct) {
+
+	// Compare the threaded product against the serial one
+	// on two random 12 qubit operators with 300 terms each
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<int> pauli(0, 3);
+	std::uniform_real_distribution<double> coeff(-1.0, 1.0);
+	auto randomOp = [&]() {
+		PauliOperator op;
+		for (int i = 0; i < 300; i++) {
+			std::map<int, std::string> ops;
+			for (int q = 0; q < 12; q++) {
+				auto p = pauli(gen);
+				if (p) {
+					ops.insert({q, std::string(1, "XYZ"[p - 1])});
+				}
+			}
+			op += PauliOperator(ops, coeff(gen));
+		}
+		return op;
+	};
+	auto a = randomOp(), b = randomOp();
+
+	auto nThreads = PauliOperator::getNumThreads();
+	PauliOperator::setNumThreads(1);
+	PauliOperator serial = a * b;
+	PauliOperator::setNumThreads(4);
+	PauliOperator parallel = a * b;
+
+	EXPECT_EQ(serial.nTerms(), parallel.nTerms());
+	EXPECT_EQ(0, (serial - parallel).nTerms());
+
+	// And the sharded sum
+	auto sum = serial + parallel;
+	PauliOperator::setNumThreads(1);
+	EXPECT_EQ(0, (sum - 2.0 * serial).nTerms());
+
+	// A SerialScope keeps the product on the calling thread
+	PauliOperator::setNumThreads(4);
+	{
+		PauliOperator::SerialScope scope;
+		EXPECT_EQ(0, (a * b - serial).nTerms());
+	}
+	PauliOperator::setNumThreads(nThreads);
+}
+
+TEST(PauliOperatorTester,checkAddProduct) {
+
+	std::complex<double> i(0,1);
+	PauliOperator sPlus0 = PauliOperator({{0,"X"}}, .5) - i * PauliOperator({{0,"Y"}}, .5);
+	PauliOperator sMinus2 = PauliOperator({{2,"X"}}, .5) + i * PauliOperator({{2,"Y"}}, .5);
+	PauliOperator z1({{1,"Z"}}, -1.0), theta("theta");
+
+	PauliOperator expected(.3);
+	expected += 2.5 * theta * sPlus0 * z1 * sMinus2;
+
+	PauliOperator fused(.3);
+	fused.addProduct(2.5, {theta, sPlus0, z1, sMinus2});
+	EXPECT_TRUE(expected.isClose(fused));
+
+	// a0^ a0^ vanishes
+	PauliOperator zero;
+	zero.addProduct(1.0, {sPlus0, sPlus0});
+	EXPECT_EQ(0, zero.nTerms());
+
+	// The destination may also be a factor
+	PauliOperator self = sPlus0;
+	self.addProduct(1.0, {self, sMinus2});
+	PauliOperator selfExpected = sPlus0 + sPlus0 * sMinus2;
+	EXPECT_TRUE(selfExpected.isClose(self));
+}
+
+TEST(PauliOperatorTester,checkTermView) {
+
+	PauliOperator op({{0,"X"}}, 1.0);
+	op += PauliOperator({{1,"Y"}}, 2.0);
+	op += PauliOperator({{2,"Z"}}, "theta");
+
+	auto view = op.getTermView();
+	EXPECT_EQ(3, view.size());
+
+	std::complex<double> sum;
+	for (auto& t : view) {
+		EXPECT_TRUE(op.hasTerm(t));
+		sum += t.coeff();
+	}
+	EXPECT_EQ(std::complex<double>(4.0), sum);
+
+	int count = 0;
+	op.forEachTerm([&](const Term& t) {
+		EXPECT_TRUE(&t == &view[count]);
+		count++;
+	});
+	EXPECT_EQ(3, count);
+
+	const PauliOperator& constOp = op;
+	EXPECT_EQ(3, std::distance(constOp.begin(), constOp.end()));
+	EXPECT_FALSE(op.hasTerm(Term({{2,"Z"}})));
+}
+
+TEST(PauliOperatorTester,checkCanonicalize) {
+
+	PauliOperator a({{3,"X"}}, 1.0), b;
+	a += PauliOperator({{0,"Z"}, {1,"Y"}}, 2.0);
+	a += PauliOperator({{0,"Z"}}, "theta");
+	a += PauliOperator(4.0);
+	b += PauliOperator(4.0);
+	b += PauliOperator({{0,"Z"}}, "theta");
+	b += PauliOperator({{0,"Z"}, {1,"Y"}}, 2.0);
+	b += PauliOperator({{3,"X"}}, 1.0);
+
+	EXPECT_FALSE(a.isCanonical());
+	EXPECT_TRUE(a == b);
+
+	a.canonicalize();
+	b.canonicalize();
+	EXPECT_TRUE(a.isCanonical());
+	EXPECT_EQ(a.toString(), b.toString());
+	EXPECT_TRUE(a == b);
+	EXPECT_TRUE(a.isClose(b));
+
+	// Canonical iteration is sorted by packed key
+	auto view = a.getTermView();
+	for (std::size_t i = 1; i < view.size(); i++) {
+		EXPECT_TRUE(Term::lessKey(view[i-1], view[i]));
+	}
+
+	// Sums of canonical operators are merged and stay sorted
+	PauliOperator c({{3,"X"}}, -1.0);
+	c += PauliOperator({{2,"Y"}}, 5.0);
+	c.canonicalize();
+	auto sum = a + c;
+	EXPECT_TRUE(sum.isCanonical());
+	EXPECT_EQ(4, sum.nTerms());
+	PauliOperator expected(4.0);
+	expected += PauliOperator({{0,"Z"}}, "theta");
+	expected += PauliOperator({{0,"Z"}, {1,"Y"}}, 2.0);
+	expected += PauliOperator({{2,"Y"}}, 5.0);
+	EXPECT_TRUE(expected.isClose(sum));
+	EXPECT_TRUE(expected.canonicalize().isClose(sum));
+	EXPECT_EQ(0, (sum - expected).nTerms());
+
+	b.canonicalize() *= PauliOperator({{0,"X"}});
+	EXPECT_FALSE(b.isCanonical());
+	EXPECT_FALSE(a.isClose(b));
+}
+
+TEST(PauliOperatorTester,checkBasisAction) {
+
+	PauliOperator op({ { 0, "X" }, { 1, "Z" }, { 2, "Y" }, { 3, "Z" } }, 2.2);
+	op += PauliOperator({ { 1, "Y" }, { 2, "Y" } }, std::complex<double>(0, 0.5));
+	op += PauliOperator({ { 3, "Z" } }, -1.0);
+	op += PauliOperator(0.3);
+
+	auto toIdx = [](const std::string& bits) {
+		std::uint64_t b = 0;
+		for (int q = 0; q < bits.length(); q++) {
+			b |= std::uint64_t(bits[q] == '1') << q;
+		}
+		return b;
+	};
+
+	std::vector<BasisAction> results;
+	std::vector<std::uint64_t> states;
+	std::vector<std::complex<double>> coeffs;
+	for (std::uint64_t i = 0; i < 16; i++) {
+		std::string bits;
+		for (int q = 0; q < 4; q++) {
+			bits += ((i >> q) & 1) ? '1' : '0';
+		}
+
+		// The integer kernels agree term by term with the bit string ones
+		auto kets = op.computeActionOnKet(bits);
+		op.computeActionOnKet(i, results);
+		op.computeActionOnKet(std::vector<std::uint64_t> { i }, states, coeffs);
+		EXPECT_EQ(kets.size(), results.size());
+		for (int t = 0; t < kets.size(); t++) {
+			EXPECT_EQ(toIdx(kets[t].first), results[t].first);
+			EXPECT_EQ(kets[t].second, results[t].second);
+			EXPECT_EQ(results[t].first, states[t]);
+			EXPECT_EQ(results[t].second, coeffs[t]);
+		}
+
+		auto bras = op.computeActionOnBra(bits);
+		op.computeActionOnBra(i, results);
+		for (int t = 0; t < bras.size(); t++) {
+			EXPECT_EQ(toIdx(bras[t].first), results[t].first);
+			EXPECT_EQ(bras[t].second, results[t].second);
+		}
+	}
+
+	// Terms past the first word need the multi-word kernel
+	PauliOperator wide({ { 1, "X" }, { 70, "Y" } }, 1.0);
+	EXPECT_XACC_ERROR(wide.computeActionOnKet(0, results));
+	std::vector<std::uint64_t> ket { 2, 0 };
+	wide.computeActionOnKet(ket, states, coeffs);
+	EXPECT_EQ(0, states[0]);
+	EXPECT_EQ(std::uint64_t(1) << 6, states[1]);
+	EXPECT_EQ(std::complex<double>(0, 1), coeffs[0]);
+	EXPECT_XACC_ERROR(wide.computeActionOnKet(std::vector<std::uint64_t> { 0 }, states, coeffs));
+}
+
+TEST(PauliOperatorTester,checkApply) {
+
+	const int nQubits = 13;
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> pauli(0, 3);
+	std::normal_distribution<double> normal;
+	std::string ops[] = { "I", "X", "Y", "Z" };
+
+	PauliOperator op;
+	for (int i = 0; i < 40; i++) {
+		std::map<int, std::string> term;
+		for (int q = 0; q < nQubits; q++) {
+			auto p = pauli(gen);
+			if (p) {
+				term[q] = ops[p];
+			}
+		}
+		op += PauliOperator(term, std::complex<double>(normal(gen), normal(gen)));
+	}
+
+	const int nVectors = 3;
+	const std::size_t dim = std::size_t(1) << nQubits;
+	std::vector<std::complex<double>> in(nVectors * dim), out(nVectors * dim);
+	for (auto& a : in) {
+		a = std::complex<double>(normal(gen), normal(gen));
+	}
+
+	// Rows of H from the basis kernel give the reference product
+	std::vector<std::complex<double>> expected(nVectors * dim);
+	std::vector<BasisAction> row;
+	for (std::uint64_t j = 0; j < dim; j++) {
+		op.computeActionOnBra(j, row);
+		for (auto& r : row) {
+			for (int v = 0; v < nVectors; v++) {
+				expected[v * dim + j] += r.second * in[v * dim + r.first];
+			}
+		}
+	}
+
+	auto nThreads = PauliOperator::getNumThreads();
+	for (int n : { 1, 3 }) {
+		PauliOperator::setNumThreads(n);
+		std::fill(out.begin(), out.end(), 1.0);
+		op.apply(in.data(), out.data(), nQubits);
+		for (std::size_t j = 0; j < dim; j++) {
+			EXPECT_NEAR(0.0, std::abs(expected[j] - out[j]), 1e-10);
+		}
+
+		op.apply(in.data(), out.data(), nQubits, nVectors);
+		for (std::size_t j = 0; j < nVectors * dim; j++) {
+			EXPECT_NEAR(0.0, std::abs(expected[j] - out[j]), 1e-10);
+		}
+	}
+	PauliOperator::setNumThreads(nThreads);
+
+	EXPECT_XACC_ERROR(op.apply(in.data(), out.data(), 4));
+	PauliOperator var({{0, "X"}}, "theta");
+	EXPECT_XACC_ERROR(var.apply(in.data(), out.data(), 1));
+}
+
+TEST(PauliOperatorTester,checkSparseMatrix) {
+
+	const int nQubits = 10;
+	std::mt19937 gen(11);
+	std::uniform_int_distribution<int> pauli(0, 3);
+	std::normal_distribution<double> normal;
+	std::string ops[] = { "I", "X", "Y", "Z" };
+
+	PauliOperator op;
+	for (int i = 0; i < 60; i++) {
+		std::map<int, std::string> term;
+		for (int q = 0; q < nQubits; q++) {
+			auto p = pauli(gen);
+			if (p && q % 3) {
+				term[q] = ops[p];
+			}
+		}
+		op += PauliOperator(term, std::complex<double>(normal(gen), normal(gen)));
+	}
+
+	const std::size_t dim = std::size_t(1) << nQubits;
+	Eigen::MatrixXcd dense = Eigen::MatrixXcd::Zero(dim, dim);
+	std::vector<BasisAction> row;
+	for (std::uint64_t j = 0; j < dim; j++) {
+		op.computeActionOnBra(j, row);
+		for (auto& r : row) {
+			dense(j, r.first) += r.second;
+		}
+	}
+
+	auto nThreads = PauliOperator::getNumThreads();
+	for (int n : { 1, 3 }) {
+		PauliOperator::setNumThreads(n);
+		auto csr = op.getCSRMatrix(nQubits);
+		for (std::uint64_t i = 0; i < dim; i++) {
+			for (auto k = csr.rowPtr[i] + 1; k < csr.rowPtr[i + 1]; k++) {
+				EXPECT_LT(csr.colIdx[k - 1], csr.colIdx[k]);
+			}
+		}
+
+		Eigen::MatrixXcd sparse = op.getSparseMatrix(nQubits);
+		EXPECT_NEAR(0.0, (sparse - dense).norm(), 1e-10);
+	}
+	PauliOperator::setNumThreads(nThreads);
+
+	std::vector<std::uint64_t> basis { 5, 1000, 17, 64, 3 };
+	Eigen::MatrixXcd sub = op.getSparseMatrix(basis);
+	for (int i = 0; i < basis.size(); i++) {
+		for (int j = 0; j < basis.size(); j++) {
+			EXPECT_NEAR(0.0, std::abs(sub(i, j) - dense(basis[i], basis[j])), 1e-10);
+		}
+	}
+}
+
+TEST(PauliOperatorTester,checkEvalPlan) {
+
+	PauliOperator op({{0, "X"}, {1, "Y"}}, 0.5, "theta");
+	op += PauliOperator({{0, "X"}, {1, "Y"}}, 2.0, "phi");
+	op += PauliOperator({{2, "Z"}}, std::complex<double>(0, 1), "theta");
+	op += PauliOperator(1.5);
+	op *= PauliOperator({{3, "Z"}}, "phi");
+
+	auto plan = op.compile({"theta"});
+	EXPECT_EQ(2, plan.nVariables());
+	EXPECT_EQ(0, plan.getVariableId("theta"));
+	EXPECT_EQ(1, plan.getVariableId("phi"));
+	EXPECT_EQ(-1, plan.getVariableId("lambda"));
+
+	// Terms differing only in variable share one numeric term
+	auto numeric = plan.instantiate();
+	EXPECT_EQ(3, numeric.nTerms());
+
+	for (double theta : { 0.3, -1.2 }) {
+		double phi = 0.7 + theta;
+		plan.evalInto(std::vector<std::complex<double>> { theta, phi }, numeric);
+
+		PauliOperator expected({{0, "X"}, {1, "Y"}, {3, "Z"}}, (0.5 * theta + 2.0 * phi) * phi);
+		expected += PauliOperator({{2, "Z"}, {3, "Z"}}, std::complex<double>(0, theta * phi));
+		expected += PauliOperator({{3, "Z"}}, 1.5 * phi);
+		EXPECT_TRUE(expected.isClose(numeric));
+
+		Eigen::VectorXd params(2);
+		params << theta, phi;
+		plan.evalInto(params, numeric);
+		EXPECT_TRUE(expected.isClose(numeric));
+	}
+
+	EXPECT_XACC_ERROR(plan.evalInto(std::vector<std::complex<double>> { 1.0 }, numeric));
+	PauliOperator other;
+	EXPECT_XACC_ERROR(plan.evalInto(std::vector<std::complex<double>> { 1.0, 2.0 }, other));
+}
+
+TEST(PauliOperatorTester,checkSaveLoad) {
+
+	PauliOperator op({{0, "X"}, {1, "Y"}}, std::complex<double>(0.5, -0.25));
+	op += PauliOperator({{2, "Z"}}, "theta");
+	op += PauliOperator({{3, "Z"}}, 2.0, "theta");
+	op += PauliOperator({{1, "X"}, {70, "Y"}}, 3.0, "phi");
+	op += PauliOperator(1.5);
+
+	std::string path = "pauli_operator_save_test.bin";
+	op.save(path);
+
+	auto loaded = PauliOperator::load(path);
+	EXPECT_EQ(op.nTerms(), loaded.nTerms());
+	EXPECT_TRUE(op == loaded);
+	EXPECT_EQ(op.toString(), loaded.toString());
+	EXPECT_FALSE(loaded.isCanonical());
+
+	MappedPauliOperator mapped(path);
+	EXPECT_EQ(5, mapped.nTerms());
+	EXPECT_EQ(2, mapped.nWords());
+	EXPECT_EQ(std::complex<double>(0.5, -0.25), mapped.coeff(0));
+	EXPECT_EQ(3, mapped.x(0)[0]);
+	EXPECT_EQ(2, mapped.z(0)[0]);
+	EXPECT_EQ("theta", mapped.var(1));
+	EXPECT_EQ("theta", mapped.var(2));
+	EXPECT_EQ("phi", mapped.var(3));
+	EXPECT_EQ("", mapped.var(4));
+	EXPECT_EQ(std::uint64_t(1) << 6, mapped.x(3)[1]);
+	EXPECT_TRUE(mapped.term(3) == Term(3.0, "phi", PauliString({{1, "X"}, {70, "Y"}})));
+
+	op.canonicalize();
+	op.save(path);
+	loaded = PauliOperator::load(path);
+	EXPECT_TRUE(loaded.isCanonical());
+	EXPECT_EQ(op.toString(), loaded.toString());
+
+	auto packed = op.pack();
+	std::ifstream in(path, std::ios::binary);
+	EXPECT_EQ(packed, std::string(std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>()));
+	EXPECT_EQ(op.toString(), PauliOperator::unpack(packed).toString());
+	EXPECT_XACC_ERROR(PauliOperator::unpack(packed.substr(0, 100)));
+	EXPECT_EQ(" is truncated.", MappedPauliOperator::validate(packed.data(), 100));
+	EXPECT_EQ("", MappedPauliOperator::validate(packed.data(), packed.size()));
+
+	PauliOperator empty;
+	empty.save(path);
+	EXPECT_EQ(0, PauliOperator::load(path).nTerms());
+	EXPECT_EQ(0, PauliOperator::unpack(empty.pack()).nTerms());
+
+	std::ofstream bad(path, std::ios::trunc);
+	bad << "not a pauli operator file, but long enough to hold a header.......";
+	bad.close();
+	PauliOperator unloaded(2.0);
+	EXPECT_FALSE(MappedPauliOperator::tryLoad(path, unloaded));
+	EXPECT_XACC_ERROR(PauliOperator::load(path));
+
+	std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+	truncated << packed.substr(0, packed.size() - 1);
+	truncated.close();
+	EXPECT_FALSE(MappedPauliOperator::tryLoad(path, unloaded));
+	EXPECT_TRUE(unloaded == PauliOperator(2.0));
+
+	std::ofstream whole(path, std::ios::binary | std::ios::trunc);
+	whole << packed;
+	whole.close();
+	EXPECT_TRUE(MappedPauliOperator::tryLoad(path, unloaded));
+	EXPECT_EQ(op.toString(), unloaded.toString());
+
+	std::remove(path.c_str());
+	EXPECT_FALSE(MappedPauliOperator::tryLoad(path, unloaded));
+	EXPECT_XACC_ERROR(PauliOperator::load(path));
 }
 
 TEST(PauliOperatorTester,checkFromXACCIR) {
@@ -0,0 +1,206 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include <gtest/gtest.h>
+#include "QubitTapering.hpp"
+#include "ExpectXACCError.hpp"
+#include <Eigen/Dense>
+#include <random>
+
+using namespace xacc::vqe;
+
+namespace {
+
+const int nQubits = 5;
+
+// A random hamiltonian on 5 qubits commuting with Z0Z1Z2Z3 and Z0Z2
+PauliOperator hamiltonian() {
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> op(0, 3);
+	std::uniform_real_distribution<double> coeff(-1, 1);
+	const char paulis[] = { 'I', 'X', 'Y', 'Z' };
+
+	PauliOperator h;
+	while (h.nTerms() < 40) {
+		PauliString p;
+		for (int q = 0; q < nQubits; q++) {
+			p.set(q, paulis[op(gen)]);
+		}
+		auto x = p.x(0);
+		if (__builtin_popcountll(x & 15) % 2 || __builtin_popcountll(x & 5) % 2) {
+			continue;
+		}
+		h.addTerm(Term(coeff(gen), "", p));
+	}
+	return h;
+}
+
+Eigen::MatrixXcd matrix(const PauliOperator& op, const int n) {
+	Eigen::MatrixXcd m = Eigen::MatrixXcd::Zero(1 << n, 1 << n);
+	for (auto& e : op.getSparseMatrixElements(n)) {
+		m(e.row(), e.col()) += e.coeff();
+	}
+	return m;
+}
+
+}
+
+TEST(QubitTaperingTester,checkSpectrum) {
+	auto h = hamiltonian();
+	auto tapering = QubitTapering::find(h, nQubits);
+	EXPECT_EQ(2, tapering.nSymmetries());
+	EXPECT_EQ(3, tapering.nReducedQubits());
+	for (int i = 0; i < tapering.nSymmetries(); i++) {
+		h.forEachTerm([&](const Term& t) {
+			EXPECT_TRUE(t.pauliString().commutes(tapering.symmetry(i)));
+		});
+	}
+
+	// Tapering in the sector of each basis state gives the spectrum
+	// of the hamiltonian restricted to that sector
+	auto full = matrix(h, nQubits);
+	for (std::uint64_t reference = 0; reference < 4; reference++) {
+		tapering.setSector(std::vector<std::uint64_t> { reference });
+
+		std::vector<int> states;
+		std::uint64_t reduced;
+		for (std::uint64_t b = 0; b < (1 << nQubits); b++) {
+			if (tapering.reduceState(b, reduced)) {
+				states.push_back(b);
+			}
+		}
+		EXPECT_EQ(8, states.size());
+		Eigen::MatrixXcd block(states.size(), states.size());
+		for (int r = 0; r < states.size(); r++) {
+			for (int c = 0; c < states.size(); c++) {
+				block(r, c) = full(states[r], states[c]);
+			}
+		}
+
+		Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> expected(block),
+				actual(matrix(tapering.taper(h), tapering.nReducedQubits()));
+		EXPECT_TRUE(expected.eigenvalues().isApprox(actual.eigenvalues(), 1e-10));
+	}
+}
+
+TEST(QubitTaperingTester,checkString) {
+	auto tapering = QubitTapering::find(hamiltonian(), nQubits);
+	tapering.setSector(std::vector<int> { -1, 1 });
+
+	auto copy = QubitTapering::fromString(tapering.toString());
+	EXPECT_EQ(tapering.toString(), copy.toString());
+	EXPECT_EQ(tapering.getSector(), copy.getSector());
+	EXPECT_EQ(tapering.getRemainingQubits(), copy.getRemainingQubits());
+	for (int q = 0; q < nQubits; q++) {
+		EXPECT_EQ(tapering.reducedQubit(q), copy.reducedQubit(q));
+	}
+
+	// The reduced state keeps the remaining qubits in order
+	std::uint64_t state = 0;
+	for (std::uint64_t b = 0; b < (1 << nQubits); b++) {
+		std::uint64_t reduced;
+		if (copy.reduceState(b, reduced)) {
+			state = b;
+			auto& remaining = copy.getRemainingQubits();
+			for (int r = 0; r < remaining.size(); r++) {
+				EXPECT_EQ((b >> remaining[r]) & 1, (reduced >> r) & 1);
+			}
+		}
+	}
+	EXPECT_NE(0, state);
+
+	// Operators past nQubits and states past one word are rejected
+	EXPECT_XACC_ERROR(QubitTapering::find(hamiltonian(), 3));
+	std::uint64_t reduced;
+	EXPECT_XACC_ERROR(QubitTapering::find(PauliOperator(), 70).reduceState(0, reduced));
+}
+
+TEST(QubitTaperingTester,checkH2Excitations) {
+
+	// The minimal basis Jordan-Wigner H2 hamiltonian, spin orbitals
+	// interleaved, commutes with Z0Z1, Z0Z2 and Z0Z3
+	PauliOperator h(-0.0971);
+	h += PauliOperator({{0, "Z"}}, 0.1712) + PauliOperator({{1, "Z"}}, 0.1712)
+			+ PauliOperator({{2, "Z"}}, -0.2228) + PauliOperator({{3, "Z"}}, -0.2228);
+	h += PauliOperator({{0, "Z"}, {1, "Z"}}, 0.1686)
+			+ PauliOperator({{0, "Z"}, {2, "Z"}}, 0.1206)
+			+ PauliOperator({{0, "Z"}, {3, "Z"}}, 0.1659)
+			+ PauliOperator({{1, "Z"}, {2, "Z"}}, 0.1659)
+			+ PauliOperator({{1, "Z"}, {3, "Z"}}, 0.1206)
+			+ PauliOperator({{2, "Z"}, {3, "Z"}}, 0.1744);
+	h += PauliOperator({{0, "X"}, {1, "X"}, {2, "Y"}, {3, "Y"}}, -0.0453)
+			+ PauliOperator({{0, "X"}, {1, "Y"}, {2, "Y"}, {3, "X"}}, 0.0453)
+			+ PauliOperator({{0, "Y"}, {1, "X"}, {2, "X"}, {3, "Y"}}, 0.0453)
+			+ PauliOperator({{0, "Y"}, {1, "Y"}, {2, "X"}, {3, "X"}}, -0.0453);
+
+	auto tapering = QubitTapering::find(h, 4);
+	EXPECT_EQ(3, tapering.nSymmetries());
+	EXPECT_EQ(1, tapering.nReducedQubits());
+	tapering.setSector(std::vector<std::uint64_t> { 3 });
+
+	// The Jordan-Wigner ladder operators
+	auto ladder = [](const int j, const bool creation) {
+		PauliOperator a(PauliOperator({{j, "X"}}, 0.5)
+				+ PauliOperator({{j, "Y"}}, std::complex<double>(0, creation ? -0.5 : 0.5)));
+		for (int k = 0; k < j; k++) {
+			a *= PauliOperator({{k, "Z"}});
+		}
+		return a;
+	};
+
+	// The singles of the UCCSD generator break the spatial symmetry
+	// and leave the sector of the reference, the double keeps it
+	auto singles = ladder(2, true) * ladder(0, false) - ladder(0, true) * ladder(2, false)
+			+ ladder(3, true) * ladder(1, false) - ladder(1, true) * ladder(3, false);
+	auto up = ladder(3, true) * ladder(2, true) * ladder(1, false) * ladder(0, false);
+	auto down = ladder(0, true) * ladder(1, true) * ladder(2, false) * ladder(3, false);
+	auto doubles = up - down;
+	EXPECT_EQ(4, singles.nTerms());
+	EXPECT_EQ(8, doubles.nTerms());
+
+	auto generator = singles + doubles;
+	EXPECT_XACC_ERROR(tapering.taper(generator));
+	EXPECT_EQ(0, tapering.commutingTerms(singles).nTerms());
+	auto kept = tapering.commutingTerms(generator);
+	EXPECT_TRUE(kept == doubles);
+
+	// The double is a rotation of the one remaining qubit
+	auto tapered = tapering.taper(kept);
+	EXPECT_EQ(1, tapered.nTerms());
+	tapered.forEachTerm([](const Term& t) {
+		EXPECT_EQ(0, t.pauliString().maxQubit());
+		EXPECT_NEAR(0.0, std::real(t.coeff()), 1e-12);
+	});
+}
+
+int main(int argc, char** argv) {
+   ::testing::InitGoogleTest(&argc, argv);
+   return RUN_ALL_TESTS();
+}
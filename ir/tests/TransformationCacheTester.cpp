@@ -0,0 +1,103 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include <gtest/gtest.h>
+#include "TransformationCache.hpp"
+#include <boost/filesystem.hpp>
+
+using namespace xacc::vqe;
+
+namespace {
+
+std::shared_ptr<FermionKernel> kernel(bool reversed) {
+	std::vector<std::shared_ptr<FermionInstruction>> insts {
+		std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 1, 1 }, { 0, 0 } }, 0.5),
+		std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 3, 1 }, { 2, 1 }, { 1, 0 }, { 0, 0 } }, -1.25),
+		std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { }, 0.7) };
+	if (reversed) {
+		std::reverse(insts.begin(), insts.end());
+	}
+
+	auto k = std::make_shared<FermionKernel>("foo");
+	for (auto& i : insts) {
+		k->addInstruction(i);
+	}
+	return k;
+}
+
+}
+
+TEST(TransformationCacheTester,checkKey) {
+	auto key = TransformationCache::key(*kernel(false), "jw", 4);
+	EXPECT_EQ(32, key.size());
+
+	// Term order does not matter, everything else does
+	EXPECT_EQ(key, TransformationCache::key(*kernel(true), "jw", 4));
+	EXPECT_NE(key, TransformationCache::key(*kernel(false), "bk", 4));
+	EXPECT_NE(key, TransformationCache::key(*kernel(false), "jw", 5));
+
+	auto other = kernel(false);
+	other->addInstruction(std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 2, 1 }, { 2, 0 } }, 1e-9));
+	EXPECT_NE(key, TransformationCache::key(*other, "jw", 4));
+}
+
+TEST(TransformationCacheTester,checkStoreLookup) {
+	auto dir = (boost::filesystem::temp_directory_path()
+			/ boost::filesystem::unique_path("vqe-cache-%%%%%%%%")).string();
+
+	PauliOperator op({{0, "X"}, {1, "Z"}}, 0.25);
+	op += PauliOperator(0.7);
+
+	PauliOperator result;
+	{
+		TransformationCache cache(dir, 1 << 20);
+		EXPECT_FALSE(cache.lookup("abc", result));
+		cache.store("abc", op);
+		EXPECT_TRUE(cache.lookup("abc", result));
+		EXPECT_TRUE(op == result);
+	}
+
+	// A limit smaller than one entry keeps nothing
+	TransformationCache tiny(dir, 16);
+	tiny.store("def", op);
+	EXPECT_FALSE(tiny.lookup("abc", result));
+	EXPECT_FALSE(tiny.lookup("def", result));
+
+	boost::filesystem::remove_all(dir);
+}
+
+int main(int argc, char** argv) {
+   ::testing::InitGoogleTest(&argc, argv);
+   return RUN_ALL_TESTS();
+}
@@ -48,6 +48,21 @@ TEST(UCCSDTester,checkUCCSD) {
 	auto f = statePrepGen.generate(buffer);
 
 	std::cout << f->toString("qreg") << "\n";
+
+	// Tapered by the symmetries Z0Z1, Z0Z2 and Z0Z3 of the Jordan-Wigner
+	// H2 hamiltonian, in the sector of the Hartree-Fock state, the singles
+	// anticommute with Z0Z1 and are dropped, and the double and the
+	// reference act on the one remaining qubit
+	auto tapering = QubitTapering::fromString("4;1:1:0.1;2:-1:0.2;3:-1:0.3");
+	auto tapered = statePrepGen.generate(
+			std::make_shared<xacc::AcceleratorBuffer>("", 1), std::vector<int>(),
+			tapering);
+	EXPECT_LT(0, tapered->nInstructions());
+	for (auto& inst : tapered->getInstructions()) {
+		for (auto bit : inst->bits()) {
+			EXPECT_EQ(0, bit);
+		}
+	}
 	xacc::Finalize();
 }
 
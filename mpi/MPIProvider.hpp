@@ -2,6 +2,7 @@
 #define MPI_MPIPROVIDER_HPP_
 
 #include "Identifiable.hpp"
+#include <functional>
 
 namespace xacc {
 namespace vqe {
@@ -21,6 +22,20 @@ public:
 	virtual void sumInts(int& myVal, int& result) = 0;
 	virtual void maxDouble(double& myVal, double& result) = 0;
 
+	/**
+	 * Combine the byte buffers d of all ranks with op along a
+	 * binary tree, leaving the result in d on rank r. op must be
+	 * associative; it is always given the data of lower ranks
+	 * as its first argument.
+	 *
+	 * @param d This rank's data, the reduced data on rank r
+	 * @param op The reduction operation
+	 * @param r The root rank
+	 */
+	virtual void reduce(std::string& d,
+			const std::function<std::string(const std::string&,
+					const std::string&)>& op, const int r) = 0;
+
 	virtual ~Communicator() {}
 
 };
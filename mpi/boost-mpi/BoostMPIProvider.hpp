@@ -44,6 +44,18 @@ public:
 		boost::mpi::all_reduce(comm, myVal, result, boost::mpi::maximum<double>());
 	}
 
+	virtual void reduce(std::string& d,
+			const std::function<std::string(const std::string&,
+					const std::string&)>& op, const int r) {
+		// Serialized types are reduced along boost's tree,
+		// which keeps lower ranks on the left of op
+		std::string out;
+		boost::mpi::reduce(comm, d, out, op, r);
+		if (comm.rank() == r) {
+			d.swap(out);
+		}
+	}
+
 	virtual ~BoostCommunicator() {}
 
 };
@@ -40,6 +40,12 @@ public:
 		result = myVal;
 	}
 
+	virtual void reduce(std::string& d,
+			const std::function<std::string(const std::string&,
+					const std::string&)>& op, const int r) {
+		return;
+	}
+
 	virtual ~NullCommunicator() {}
 
 };
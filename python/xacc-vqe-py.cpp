@@ -177,13 +177,9 @@ VQETaskResult execute(PauliOperator& op, py::kwargs kwargs) {
 	std::string task = "vqe-diagonalize";
 
 	int maxQbit = 0;
-	for (auto& kv : op.getTerms()) {
-		if (!kv.second.isIdentity()) {
-			int qbit = kv.second.ops().rbegin()->first;
-			if (qbit > maxQbit)
-				maxQbit = qbit;
-		}
-	}
+	op.forEachTerm([&](const Term& t) {
+		maxQbit = std::max(maxQbit, t.pauliString().maxQubit());
+	});
 	int nQubits = maxQbit + 1;
 
 	if (kwargs) {
@@ -387,7 +383,8 @@ PYBIND11_MODULE(pyxaccvqe, m) {
 	    .def_readonly("vqeIterations", &VQETaskResult::vqeIterations)
 	    .def_readonly("energy", &VQETaskResult::energy);
 
-	py::class_<Term>(m,"Term").def("coeff", &Term::coeff);
+	py::class_<Term>(m,"Term").def("coeff",
+			static_cast<const std::complex<double>& (Term::*)() const>(&Term::coeff));
 	py::class_<PauliOperator>(m,"PauliOperator")
 			.def(py::init<>())
 			.def(py::init<std::complex<double>>())
@@ -409,7 +406,10 @@ PYBIND11_MODULE(pyxaccvqe, m) {
 			.def("__eq__", &PauliOperator::operator==)
 			.def("__repr__", &PauliOperator::toString)
 			.def("eval", &PauliOperator::eval)
+			.def("compile", &PauliOperator::compile, py::arg("variables") = std::vector<std::string>{})
 			.def("toXACCIR", &PauliOperator::toXACCIR)
+			.def("save", &PauliOperator::save)
+			.def_static("load", &PauliOperator::load)
 			.def("nTerms", &PauliOperator::nTerms)
 			.def("isClose", &PauliOperator::isClose)
 			.def("__len__", &PauliOperator::nTerms)
@@ -417,6 +417,14 @@ PYBIND11_MODULE(pyxaccvqe, m) {
 			[](PauliOperator& op) {return py::make_iterator(op.begin(), op.end());},
 			py::keep_alive<0, 1>());
 
+	py::class_<EvalPlan>(m,"EvalPlan")
+			.def("getVariables", &EvalPlan::getVariables)
+			.def("nVariables", &EvalPlan::nVariables)
+			.def("instantiate", &EvalPlan::instantiate)
+			.def("evalInto", (void (EvalPlan::*)(const std::vector<std::complex<double>>&,
+					PauliOperator&) const) &EvalPlan::evalInto)
+			.def("eval", &EvalPlan::eval);
+
 	py::class_<StatePreparationEvaluator>(m, "AnsatzEvaluator").def_static("evaluate",StatePreparationEvaluator::evaluateCircuit, "");
 
 	m.def("execute", (VQETaskResult (*)(PauliOperator& op, py::kwargs kwargs))
@@ -7,6 +7,9 @@
 #include "IRGenerator.hpp"
 #include "PauliOperator.hpp"
 #include "FermionToSpinTransformation.hpp"
+#include "UCCSD.hpp"
+#include "QubitTapering.hpp"
+#include "LinearEncoding.hpp"
 
 #include "MPIProvider.hpp"
 #include "CountGatesOfTypeVisitor.hpp"
@@ -103,7 +106,11 @@ public:
 	virtual std::shared_ptr<options_description> getOptions() {
 		auto desc = std::make_shared<options_description>(
 				"VQE Program Options");
-		desc->add_options()("correct-readout-errors", "Turn on readout-error correction.");
+		desc->add_options()("correct-readout-errors", "Turn on readout-error correction.")
+				("taper-qubits", "Remove the qubits fixed by Z2 symmetries of the "
+						"spin Hamiltonian, in the sector of the Hartree-Fock state. "
+						"n-qubits stays the number of modes, and qubit-map maps the "
+						"remaining qubits.");
 		return desc;
 
 	}
@@ -165,11 +172,10 @@ public:
 				addIRPreprocessor("readout-error-preprocessor");
 			}
 
-			// Start compilation
-			Program::build();
-
+			// The fermion compiler runs this transformation, let
+			// it split the terms over our ranks
+			std::shared_ptr<FermionToSpinTransformation> transform;
 			if (!userProvidedKernels) {
-				std::shared_ptr<FermionToSpinTransformation> transform;
 				if (xacc::optionExists("fermion-transformation")) {
 					auto transformStr = xacc::getOption(
 							"fermion-transformation");
@@ -179,15 +185,20 @@ public:
 					transform = xacc::getService<
 							FermionToSpinTransformation>("jw");
 				}
-				pauli = transform->getResult();
+				transform->setCommunicator(comm);
+			}
+
+			// Start compilation
+			Program::build();
 
-				// Rerun the build and get reference to the
-				// generated fermionkernel
-				xacc::setOption("no-fermion-transformation","");
-				auto c = getCompiler("fermion");
-				auto ir = c->compile(src, accelerator);
-				fermionKernel = std::dynamic_pointer_cast<FermionKernel>(ir->getKernels()[0]);
-				xacc::unsetOption("no-fermion-transformation");
+			if (!userProvidedKernels) {
+				// The single compilation above leaves both the spin
+				// Hamiltonian and the fermion kernel it came from
+				// on the transformation
+				pauli = transform->getResult();
+				pauli.canonicalize();
+				fermionKernel = transform->getFermionKernel();
+				modeOrdering = fermionKernel->getModePermutation();
 			}
 
 			nQubits = std::stoi(xacc::getOption("n-qubits"));
@@ -195,6 +206,10 @@ public:
 			// Get the Kernels that were created
 			kernels = getRuntimeKernels();
 
+			if (!userProvidedKernels && xacc::optionExists("taper-qubits")) {
+				taperQubits();
+			}
+
 			if (userProvidedKernels) {
 				if (boost::contains(src, "pragma")
 						&& boost::contains(src, "coefficient")) {
@@ -222,6 +237,7 @@ public:
 					}
 
 					pauli.fromXACCIR(xaccIR);
+					pauli.canonicalize();
 				}
 			}
 
@@ -233,6 +249,7 @@ public:
 			}
 
 			nQubits = std::stoi(xacc::getOption("n-qubits"));
+			pauli.canonicalize();
 			auto tmpKernels = pauli.toXACCIR()->getKernels();
 			xaccIR = xacc::getService<IRProvider>("gate")->createIR();
 			for (auto t : tmpKernels) {
@@ -323,12 +340,44 @@ public:
 		return nParameters;
 	}
 
+	/**
+	 * Return the number of qubits the Hamiltonian acts on, fewer
+	 * than the n-qubits modes if qubits were tapered off.
+	 */
 	const int getNQubits() {
 		return nQubits;
 	}
 
 	void setNQubits(const int n) {nQubits = n;}
 
+	/**
+	 * Return the number of fermionic modes, which is also the
+	 * number of qubits before any were tapered off.
+	 */
+	const int getNModes() {
+		return tapering.nSymmetries() ? tapering.nQubits() : nQubits;
+	}
+
+	/**
+	 * Return the qubit each fermionic mode was placed on, entry m
+	 * being the qubit of mode m, or an empty vector if the modes
+	 * were not reordered. The Hamiltonian, the integrals and the
+	 * ansatz all act on the reordered modes.
+	 */
+	const std::vector<int>& getModeOrdering() {
+		return modeOrdering;
+	}
+
+	/**
+	 * Return the Z2 symmetry tapering applied to the Hamiltonian,
+	 * with no symmetries if taper-qubits was not given. The
+	 * Hamiltonian, its kernels and a generated ansatz then act
+	 * on its reduced qubits.
+	 */
+	const QubitTapering& getTapering() {
+		return tapering;
+	}
+
 	const std::string getStatePrepType() {
 		return statePrepType;
 	}
@@ -344,19 +393,26 @@ public:
 		return fermionKernel->E_nuc();
 	}
 
-	Eigen::Tensor<std::complex<double>, 2> hpq() {
+	/**
+	 * Return a view of the one-electron integrals over
+	 * spin orbitals, backed by the kernel's IntegralStore.
+	 */
+	OneBodyIntegrals hpq() {
 		if (!fermionKernel) {
 			xacc::error("Cannot get h_pq if you did not compile with FermionCompiler");
 		}
-		return fermionKernel->hpq(nQubits);
+		return fermionKernel->hpq(getNModes());
 	}
 
-	Eigen::Tensor<std::complex<double>, 4> hpqrs() {
+	/**
+	 * Return a view of the two-electron integrals over
+	 * spin orbitals, backed by the kernel's IntegralStore.
+	 */
+	TwoBodyIntegrals hpqrs() {
 		if (!fermionKernel) {
 			xacc::error("Cannot get h_pqrs if you did not compile with FermionCompiler");
 		}
-		return fermionKernel->hpqrs(
-				nQubits);
+		return fermionKernel->hpqrs(getNModes());
 	}
 
 	virtual ~VQEProgram() {
@@ -374,6 +430,10 @@ protected:
 
 	std::shared_ptr<FermionKernel> fermionKernel;
 
+	std::vector<int> modeOrdering;
+
+	QubitTapering tapering;
+
 	/**
 	 * Reference to the state preparation circuit
 	 * represented as XACC IR.
@@ -399,6 +459,76 @@ protected:
 	 */
 	int nParameters;
 
+	/**
+	 * Taper the qubits fixed by the Z2 symmetries of the spin
+	 * Hamiltonian, in the sector of the Hartree-Fock state, and
+	 * rebuild the kernels on the remaining qubits.
+	 */
+	void taperQubits() {
+		if (!xacc::optionExists("n-electrons")) {
+			xacc::error("Tapering qubits requires the n-electrons option "
+					"to choose the symmetry sector.");
+		}
+
+		tapering = QubitTapering::find(pauli, nQubits);
+		if (comm->rank() == 0) {
+			xacc::info("Found " + std::to_string(tapering.nSymmetries())
+					+ " Z2 symmetries of the spin Hamiltonian.");
+		}
+		if (tapering.nSymmetries() == 0) {
+			return;
+		}
+
+		// The Hartree-Fock state occupies the lowest modes, on the
+		// qubits they were placed on
+		auto nElectrons = std::stoi(xacc::getOption("n-electrons"));
+		std::vector<std::uint64_t> state((nQubits + 63) / 64);
+		for (int m = 0; m < nElectrons; m++) {
+			auto q = modeOrdering.empty() ? m : modeOrdering[m];
+			state[q >> 6] |= std::uint64_t(1) << (q & 63);
+		}
+
+		auto transformation =
+				xacc::optionExists("fermion-transformation") ?
+						xacc::getOption("fermion-transformation") : "jw";
+		if (transformation == "bk" || transformation == "linear-encoding") {
+			auto encoding =
+					transformation == "bk" ?
+							LinearEncoding::bravyiKitaev(nQubits) :
+							LinearEncoding::fromOptions(nQubits);
+			auto occupations = state;
+			encoding.encode(occupations.data(), state.data());
+		} else if (transformation == "ternary-tree") {
+			xacc::error("The ternary tree transformation has no basis "
+					"state for the Hartree-Fock sector, cannot taper qubits.");
+		}
+
+		tapering.setSector(state);
+		pauli = tapering.taper(pauli);
+		pauli.canonicalize();
+		nQubits = tapering.nReducedQubits();
+
+		// Rebuild the kernels on the remaining qubits, which
+		// qubit-map then places on physical qubits
+		auto tmpKernels = pauli.toXACCIR()->getKernels();
+		xaccIR = xacc::getService<IRProvider>("gate")->createIR();
+		for (auto t : tmpKernels) {
+			xaccIR->addKernel(t);
+		}
+
+		auto accTransforms = accelerator->getIRTransformations();
+		for (auto t : accTransforms) {
+			xaccIR = t->transform(xaccIR);
+		}
+
+		bufferPostprocessors.clear();
+		for (auto irp : irpreprocessors) {
+			bufferPostprocessors.push_back(irp->process(*xaccIR));
+		}
+
+		kernels = getRuntimeKernels();
+	}
+
 	std::shared_ptr<Function> createStatePreparationCircuit() {
 
 		if (!statePrepSource.empty()) {
@@ -443,8 +573,15 @@ protected:
 
 			auto statePrepGenerator = xacc::getService<
 					IRGenerator>(statePrepType);
-			return statePrepGenerator->generate(
-					std::make_shared<AcceleratorBuffer>("", nQubits));
+			auto buffer = std::make_shared<AcceleratorBuffer>("", nQubits);
+
+			// UCCSD acts on the qubits the modes were placed on,
+			// less the ones tapered off
+			auto uccsd = std::dynamic_pointer_cast<UCCSD>(statePrepGenerator);
+			if (uccsd) {
+				return uccsd->generate(buffer, modeOrdering, tapering);
+			}
+			return statePrepGenerator->generate(buffer);
 		}
 	}
 
@@ -1,4 +1,5 @@
 #include "FermionToSpinTransformation.hpp"
+#include "LinearEncoding.hpp"
 #include <iostream>
 #include <unordered_map>
 
@@ -11,7 +12,6 @@ namespace vqe {
 
 VQETaskResult DiagonalizeTask::execute(
 		Eigen::VectorXd parameters) {
-	int nQubits = std::stoi(xacc::getOption("n-qubits"));
 
 	auto hamiltonianInstruction = program->getPauliOperator();
 
@@ -45,12 +45,23 @@ double EigenDiagonalizeBackend::diagonalize(
 	Eigen::VectorXd eigenvalues;
 	if (xacc::optionExists("diag-number-symmetry") && 
 			xacc::optionExists("n-electrons")) {
+		// Ternary tree states are not a linear image of
+		// occupation bit strings, so there is no subspace to take
+		if (fermionTransformation == "ternary-tree") {
+			xacc::error("diag-number-symmetry is not supported with the "
+					"ternary-tree fermion-transformation.");
+		}
+
 		int nElectrons = std::stoi(xacc::getOption("n-electrons"));
 
+		// A tapered hamiltonian has fewer qubits than modes
+		auto& tapering = prog->getTapering();
+		auto nModes = prog->getNModes();
+
 		// Generate all n-qubit bitstrings with n-electron
 		// bits set
 		std::string initBitString = "";
-		for (int i = 0; i < nQubits - nElectrons; i++)
+		for (int i = 0; i < nModes - nElectrons; i++)
 			initBitString += "0";
 		for (int i = 0; i < nElectrons; i++)
 			initBitString += "1";
@@ -63,88 +74,38 @@ double EigenDiagonalizeBackend::diagonalize(
 		} while (std::next_permutation(initBitString.begin(),
 				initBitString.end()));
 
-		// Transform bit strings from occupation basis
-		// to bravyi kitaev basis if needed
+		// Transform bit strings from the occupation basis to the
+		// qubit basis of the encoding the hamiltonian was mapped with
+		std::shared_ptr<LinearEncoding> encoding;
 		if (fermionTransformation == "bk") {
+			encoding = std::make_shared<LinearEncoding>(
+					LinearEncoding::bravyiKitaev(nModes));
+		} else if (fermionTransformation == "linear-encoding") {
+			encoding = std::make_shared<LinearEncoding>(
+					LinearEncoding::fromOptions(nModes));
+		}
 
-			// Build up BK transformation matrix
-			Eigen::MatrixXi B(1,1); B(0,0) = 1;
-			while (true) {
-
-				Eigen::MatrixXi oldB = B;
-				Eigen::MatrixXi ones = Eigen::MatrixXi::Ones(1,oldB.cols());
-				B.resize(oldB.rows()*2, oldB.cols()*2);
-				B.setZero();
-
-				// Set 2nd quadrant
-				B.block(0,0,oldB.rows(), oldB.cols()) = oldB;
-
-				// Set 4th quadrant
-				B.block(oldB.rows(), oldB.cols(), oldB.rows(), oldB.cols()) = oldB;
-
-				// Set the ones in the first quadrant
-				B.block(0, B.cols()-oldB.cols(), ones.rows(), ones.cols()) = ones;
-
-				if (B.rows() == nQubits) {
-					break;
-				} else if (B.rows() > nQubits) {
-					std::cout << "Getting Subblock:\n" << B << "\n\n";
-					Eigen::MatrixXi subB = B.block(B.rows()-nQubits, B.cols()-nQubits, nQubits, nQubits);
-//					subB.block(nQubits-1, 0, 1, nQubits) = Eigen::MatrixXi::Ones(1,nQubits);
-					B = subB;
-					break;
-				}
+		// Pack each bit string into a basis index, character i
+		// of the string being the occupation of mode i
+		std::vector<std::uint64_t> basis;
+		std::unordered_map<std::uint64_t, std::uint64_t> basisToIdx;
+		for (auto& bs : bitStrings) {
+			std::uint64_t b = 0;
+			for (int q = 0; q < bs.length(); q++) {
+				b |= std::uint64_t(bs[q] == '1') << q;
 			}
-
-			std::cout << "SeeleyBK=\n" << B << "\n\n";
-
-			int end = nQubits-1;
-			for (int start = 0; ; start++) {
-				B.row(start).swap(B.row(end));
-				end--;
-				if (start == end) break;
+			if (encoding) {
+				b = encoding->encode(b);
 			}
-
-			end = nQubits -1;
-			for (int start = 0; ; start++) {
-				B.col(start).swap(B.col(end));
-				end--;
-				if (start == end) break;
+			// Keep the states in the tapered sector, on the
+			// remaining qubits
+			if (tapering.nSymmetries() && !tapering.reduceState(b, b)) {
+				continue;
 			}
-
-			std::cout << "TranterBK:\n" << B << "\n";
-
-			std::vector<std::string> newBitStrings;
-			for (auto& bs : bitStrings) {
-				Eigen::VectorXi x(nQubits);
-				for (int i = 0; i < bs.length(); i++) {
-					x(i) = bs[i] == '1' ? 1 : 0;
-				}
-
-				Eigen::VectorXi y = B * x;
-				for (int i = 0; i < y.size(); i++) y(i) %= 2;
-
-				std::string newbitstring = "";
-				for (int i = 0; i < y.size(); i++) {
-					newbitstring += y(i) == 0 ? '0' : '1';
-				}
-				newBitStrings.push_back(newbitstring);
-			}
-
-			bitStrings.clear();
-			bitStrings = newBitStrings;
+			basisToIdx.insert( { b, basis.size() });
+			basis.push_back(b);
 		}
-
-		std::map<std::string, std::uint64_t> bitsToIdx;
-		std::map<std::uint64_t, std::string> idxToBits;
-
-		std::uint64_t counter = 0;
-		for (auto& bs : bitStrings) {
-			bitsToIdx.insert( { bs, counter });
-			idxToBits.insert( { counter, bs });
-			counter++;
-		}
-		int nBitStrings = counter;
+		int nBitStrings = basis.size();
 
 		xacc::info("Considering Hamiltonian subspace spanned by "
 				+ std::to_string(nBitStrings) + " eigenstates with "
@@ -152,22 +113,15 @@ double EigenDiagonalizeBackend::diagonalize(
 
 		Eigen::MatrixXcd mat(nBitStrings, nBitStrings);
 		mat.setZero();
+		std::vector<BasisAction> results;
 		for (std::uint64_t i = 0; i < nBitStrings; i++) {
-			auto bitStr = idxToBits[i];
-			auto braResults = hamiltonian.computeActionOnKet(bitStr);
-
-			for (auto& r : braResults) {
-				if (bitStr == r.first) {
-					mat(i, i) += r.second;
+			hamiltonian.computeActionOnKet(basis[i], results);
+			for (auto& result : results) {
+				auto k = basisToIdx.find(result.first);
+				if (k != basisToIdx.end()) {
+					mat(i, k->second) += result.second;
 				}
 			}
-
-			for (auto& result : braResults) {
-				std::uint64_t k = bitsToIdx[result.first];
-				if (i != k)
-					mat(i, k) += result.second;
-			}
-
 		}
 		Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> es(mat);
 
@@ -178,19 +132,13 @@ double EigenDiagonalizeBackend::diagonalize(
 		for (int i = 0; i < nQubits; i++)
 			dim *= two;
 		
-		auto getBitStrForIdx = [&](std::uint64_t i) {
-			std::stringstream s;
-			for (int k = nQubits - 1; k >= 0; k--) s << ((i >> k) & 1);
-			return s.str();
-		};
 		Eigen::MatrixXcd A(dim, dim);
 		A.setZero();
+		std::vector<BasisAction> results;
 		for (std::uint64_t myRow = 0; myRow < dim; myRow++) {
-			auto rowBitStr = getBitStrForIdx(myRow);
-			auto results = hamiltonian.computeActionOnBra(rowBitStr);
+			hamiltonian.computeActionOnBra(myRow, results);
 			for (auto& result : results) {
-				std::uint64_t k = std::stol(result.first, nullptr, 2);
-				A(myRow, k) += result.second;
+				A(myRow, result.first) += result.second;
 			}
 		}
 
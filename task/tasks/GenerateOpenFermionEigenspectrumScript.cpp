@@ -42,19 +42,13 @@ VQETaskResult GenerateOpenFermionEigenspectrumScript::execute(
 		s << "from openfermion.utils import eigenspectrum\n";
 		s << "op = \\\n";
 
-		auto terms = hamiltonianInstruction.getTerms();
-		int nInsts = terms.size();
+		int nInsts = hamiltonianInstruction.nTerms();
 		int i = 0;
-		for (auto& kv : terms) {
-			auto spin = kv.second;
+		hamiltonianInstruction.forEachTerm([&](const Term& spin) {
 			std::string termStr = "";
-			for (auto term : spin.ops()) {
-				if (term.second != "I") {
-					termStr += " " + term.second + std::to_string(term.first) + " ";
-				} else {
-					termStr += "";
-				}
-			}
+			spin.pauliString().forEachOp([&](const int q, const char op) {
+				termStr += " " + std::string(1, op) + std::to_string(q) + " ";
+			});
 
 			if (i == nInsts-1) {
 				s << "   QubitOperator('" << termStr << "', complex" << spin.coeff() << ")\n";
@@ -62,7 +56,7 @@ VQETaskResult GenerateOpenFermionEigenspectrumScript::execute(
 				s << "   QubitOperator('" << termStr << "', complex" << spin.coeff() << ") + \\\n";
 			}
 			i++;
-		}
+		});
 
 		s << "\n\nes = eigenspectrum(op)\n";
 		s << "print('Energies = ', es)\n";
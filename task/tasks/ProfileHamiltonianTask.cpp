@@ -37,7 +37,7 @@ VQETaskResult ProfileHamiltonianTask::execute(
 				FermionToSpinTransformation>(transform)->getResult();
 
 		std::stringstream s;
-		s << "Number of Qubits = " << xacc::getOption("n-qubits") << "\n";
+		s << "Number of Qubits = " << program->getNQubits() << "\n";
 		s << "Number of Hamiltonian Terms = "
 				<< std::to_string(kernels.size()) << "\n";
 
@@ -53,7 +53,7 @@ VQETaskResult ProfileHamiltonianTask::execute(
 			s << "jordan-wigner\n";
 		}
 
-		xacc::info("Number of Qubits = " + xacc::getOption("n-qubits"));
+		xacc::info("Number of Qubits = " + std::to_string(program->getNQubits()));
 		xacc::info(
 				"Number of Hamiltonian Terms = "
 						+ std::to_string(kernels.size()));
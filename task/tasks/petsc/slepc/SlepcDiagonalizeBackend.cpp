@@ -34,12 +34,6 @@ double SlepcDiagonalizeBackend::diagonalize(std::shared_ptr<VQEProgram> prog) {
 	for (int i = 0; i < nQubits; i++)
 		dim *= two;
 
-	auto getBitStrForIdx = [&](std::uint64_t i) {
-		std::stringstream s;
-		for (int k = nQubits - 1; k >= 0; k--) s << ((i >> k) & 1);
-		return s.str();
-	};
-
 	SlepcInitialize(&argc, &argv, (char*) 0, help);
 
 	Mat A;
@@ -58,12 +52,11 @@ double SlepcDiagonalizeBackend::diagonalize(std::shared_ptr<VQEProgram> prog) {
 	if (rank == 0) xacc::info(
 			"Building Matrix for SLEPc.");
 
+	std::vector<BasisAction> results;
 	for (std::uint64_t myRow = Istart; myRow < Iend; myRow++) {
-		auto rowBitStr = getBitStrForIdx(myRow);
-		auto results = inst.computeActionOnBra(rowBitStr);
+		inst.computeActionOnBra(myRow, results);
 		for (auto& result : results) {
-			std::uint64_t k = std::stol(result.first, nullptr, 2);
-			MatSetValue(A, myRow, k, result.second, ADD_VALUES);
+			MatSetValue(A, myRow, result.first, result.second, ADD_VALUES);
 		}
 	}
 
@@ -35,7 +35,9 @@
 #include "FermionKernel.hpp"
 #include "FermionIR.hpp"
 #include "PauliOperator.hpp"
+#include "MPIProvider.hpp"
 #include <boost/math/constants/constants.hpp>
+#include <thread>
 
 #include <boost/serialization/complex.hpp>
 #include <boost/serialization/vector.hpp>
@@ -64,6 +66,52 @@ public:
 		return PauliOperator();
 	}
 
+	/**
+	 * Return the fermion kernel the current result was
+	 * transformed from.
+	 */
+	virtual std::shared_ptr<FermionKernel> getFermionKernel() {
+		return fermionKernel;
+	}
+
+	/**
+	 * Set the result of this transformation without running it,
+	 * for example from a cached earlier transformation of kernel.
+	 *
+	 * @param op The transformed operator
+	 * @param kernel The fermion kernel it was transformed from
+	 */
+	virtual void setResult(const PauliOperator& op,
+			std::shared_ptr<FermionKernel> kernel) {
+		result = op;
+		fermionKernel = kernel;
+	}
+
+	/**
+	 * Return the name of this transformation followed by any
+	 * parameters its result on nQubits qubits depends on, so
+	 * that cached results are only reused for the same mapping.
+	 *
+	 * @param nQubits The number of qubits
+	 * @return key The transformation part of the cache key
+	 */
+	virtual std::string cacheKey(const int nQubits) {
+		return name();
+	}
+
+	/**
+	 * Set the communicator whose ranks share the work of
+	 * transform. Without one, each process maps every term.
+	 *
+	 * @param c The communicator
+	 */
+	virtual void setCommunicator(std::shared_ptr<Communicator> c) {
+		comm = c;
+	}
+
+	/**
+	 * If false, transform runs serially on every rank.
+	 */
 	bool runParallel = true;
 
 protected:
@@ -75,6 +123,131 @@ protected:
 
 	std::shared_ptr<FermionKernel> fermionKernel;
 
+	std::shared_ptr<Communicator> comm;
+
+	/**
+	 * Set result to the sum of the images of nTerms fermion terms,
+	 * where mapRange(begin, end, op) adds the images of terms
+	 * [begin, end) to op. The terms are split into contiguous
+	 * ranges across the communicator's ranks and then across
+	 * PauliOperator::threadsHere() threads, so mapRange must be
+	 * safe to call concurrently. Each thread maps its range with
+	 * serial PauliOperator arithmetic and the threads' operators
+	 * are accumulated in place. The ranks' packed operators are
+	 * reduced along a tree and broadcast, leaving the full result
+	 * on every rank.
+	 *
+	 * @param nTerms The number of fermion terms
+	 * @param mapRange The functor mapping a range of terms
+	 */
+	template<typename F>
+	void mapTerms(const std::size_t nTerms, F mapRange) {
+		std::size_t rank = 0, nRanks = 1;
+		if (runParallel && comm) {
+			rank = comm->rank();
+			nRanks = comm->size();
+		}
+		auto begin = rank * nTerms / nRanks;
+		auto end = (rank + 1) * nTerms / nRanks;
+
+		// Threads only pay off with a few hundred terms each
+		std::size_t nThreads = 1;
+		if (runParallel) {
+			nThreads = std::min<std::size_t>(PauliOperator::threadsHere(),
+					(end - begin) / 256);
+			nThreads = std::max<std::size_t>(nThreads, 1);
+		}
+
+		std::vector<PauliOperator> partial(nThreads);
+		if (nThreads == 1) {
+			mapRange(begin, end, partial[0]);
+		} else {
+			std::vector<std::thread> threads;
+			for (std::size_t t = 0; t < nThreads; t++) {
+				auto first = begin + t * (end - begin) / nThreads;
+				auto last = begin + (t + 1) * (end - begin) / nThreads;
+				threads.emplace_back([&, first, last, t]() {
+					PauliOperator::SerialScope serial;
+					mapRange(first, last, partial[t]);
+				});
+			}
+			for (auto& t : threads) {
+				t.join();
+			}
+
+			// Accumulate the partial images in place, the sharded
+			// sum would rescan partial[0] for each of them
+			PauliOperator::SerialScope serial;
+			for (std::size_t t = 1; t < nThreads; t++) {
+				partial[0] += partial[t];
+			}
+		}
+		result = partial[0];
+
+		if (nRanks > 1) {
+			auto packed = result.pack();
+			comm->reduce(packed,
+					[](const std::string& a, const std::string& b) {
+						auto sum = PauliOperator::unpack(a);
+						sum += PauliOperator::unpack(b);
+						return sum.pack();
+					}, 0);
+			comm->broadcast(packed, 0);
+			result = PauliOperator::unpack(packed);
+		}
+	}
+
+	/**
+	 * Set result to the image of kernel under the mapping sending
+	 * a_i^+ to creation[i] and a_i to annihilation[i]. Each distinct
+	 * normal ordered term is mapped once as a product of the images,
+	 * its hermitian conjugate mapping to the adjoint of that product.
+	 *
+	 * @param kernel The fermion kernel
+	 * @param creation The images of the creation operators
+	 * @param annihilation The images of the annihilation operators
+	 */
+	void mapLadderProducts(FermionKernel& kernel,
+			const std::vector<PauliOperator>& creation,
+			const std::vector<PauliOperator>& annihilation) {
+		std::vector<std::complex<double>> conjugates;
+		auto fermions = kernel.getOperator().normalOrdered(&conjugates);
+
+		mapTerms(fermions.nTerms(),
+				[&](const std::size_t begin, const std::size_t end, PauliOperator& op) {
+			for (std::size_t z = begin; z < end; ++z) {
+
+				// Get the creation or annihilation sites
+				auto termSites = fermions.sites(z);
+				auto nSites = fermions.nOperators(z);
+
+				auto& coeff = fermions.coeff(z);
+				auto& conjugate = conjugates[z];
+				auto& fermionVar = fermions.var(z);
+
+				PauliOperator scale(conjugate == 0.0 ? coeff : 1.0, fermionVar);
+				std::vector<std::reference_wrapper<const PauliOperator>> refs(1, scale);
+				for (int i = 0; i < nSites; i++) {
+					auto index = termSites[i];
+					refs.push_back(fermions.isCreation(z, i) ?
+							creation[index] : annihilation[index]);
+				}
+
+				if (conjugate == 0.0) {
+					op.addProduct(1.0, refs);
+				} else {
+					PauliOperator image;
+					image.addProduct(1.0, refs);
+					op += image.hermitianConjugate() * conjugate;
+					if (coeff != 0.0) {
+						image *= coeff;
+						op += image;
+					}
+				}
+			}
+		});
+	}
+
 };
 
 }
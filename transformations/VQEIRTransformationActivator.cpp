@@ -32,6 +32,9 @@
 #include "BravyiKitaevIRTransformation.hpp"
 #include "EfficientJW.hpp"
 #include "LongRangeJW.hpp"
+#include "DirectJW.hpp"
+#include "LinearEncodingTransformation.hpp"
+#include "TernaryTreeTransformation.hpp"
 
 #include "cppmicroservices/BundleActivator.h"
 #include "cppmicroservices/BundleContext.h"
@@ -60,6 +63,9 @@ public:
 		auto c3 = std::make_shared<xacc::vqe::BravyiKitaevIRTransformation>();
 		auto c4 = std::make_shared<xacc::vqe::EfficientJW>();
 		auto c5 = std::make_shared<xacc::vqe::LongRangeJW>();
+		auto c6 = std::make_shared<xacc::vqe::DirectJW>();
+		auto c7 = std::make_shared<xacc::vqe::LinearEncodingTransformation>();
+		auto c8 = std::make_shared<xacc::vqe::TernaryTreeTransformation>();
 
 		context.RegisterService<xacc::IRTransformation>(c);
 		context.RegisterService<xacc::vqe::FermionToSpinTransformation>(c);
@@ -70,6 +76,15 @@ public:
 		context.RegisterService<xacc::vqe::FermionToSpinTransformation>(c5);
 		context.RegisterService<xacc::IRTransformation>(c5);
 
+		context.RegisterService<xacc::vqe::FermionToSpinTransformation>(c6);
+		context.RegisterService<xacc::IRTransformation>(c6);
+
+		context.RegisterService<xacc::vqe::FermionToSpinTransformation>(c7);
+		context.RegisterService<xacc::IRTransformation>(c7);
+
+		context.RegisterService<xacc::vqe::FermionToSpinTransformation>(c8);
+		context.RegisterService<xacc::IRTransformation>(c8);
+
 	}
 
 	/**
@@ -31,7 +31,7 @@
 #ifndef VQE_IR_BravyiKitaevIRTransformation_HPP_
 #define VQE_IR_BravyiKitaevIRTransformation_HPP_
 
-#include "FermionToSpinTransformation.hpp"
+#include "LinearEncodingTransformation.hpp"
 
 namespace xacc {
 
@@ -44,20 +44,18 @@ namespace vqe {
  * a GateQIR instance.
  *
  * Specifically, this transformation will generate N GateFunctions,
- * one for each term in the generated spin-based hamiltonian.
+ * one for each term in the generated spin-based hamiltonian. It is
+ * the LinearEncodingTransformation for the Fenwick tree encoding.
  */
-class BravyiKitaevIRTransformation: public FermionToSpinTransformation {
+class BravyiKitaevIRTransformation: public LinearEncodingTransformation {
 
-public:
+protected:
+
+	virtual LinearEncoding getEncoding(const int nQubits) {
+		return LinearEncoding::bravyiKitaev(nQubits);
+	}
 
-	/**
-	 * Transform a FermionIR instance to a GateQIR instance.
-	 *
-	 * @param ir
-	 * @return
-	 */
-	virtual std::shared_ptr<IR> transform(std::shared_ptr<IR> ir);
-	virtual PauliOperator transform(FermionKernel& kernel);
+public:
 
 	virtual const std::string name() const {
 		return "bk";
@@ -3,6 +3,12 @@
 #define VQE_TRANSFORMATION_BK_FENWICK_HPP_
 
 #include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
 
 /**
  * This class represents a Node in the Fenwick Tree. It keeps track
@@ -175,5 +181,134 @@ public:
 	}
 };
 
+/**
+ * FenwickMasks holds the update, parity and remainder sets of
+ * every index of an nQubits FenwickTree as flat bitmasks, nWords()
+ * 64-bit words per index, with bit j set if qubit j is in the set.
+ * The Bravyi-Kitaev image of a ladder operator on qubit i is then
+ * (X_i X_U(i) Z_P(i) -+ i Y_i X_U(i) Z_R(i)) / 2, so its packed
+ * Pauli strings can be read straight from the masks.
+ *
+ * The masks depend only on the number of qubits; get() builds
+ * them once per qubit count and shares them between callers.
+ */
+class FenwickMasks {
+
+protected:
+
+	int n;
+
+	std::size_t nw;
+
+	std::vector<std::uint64_t> updateMasks;
+	std::vector<std::uint64_t> parityMasks;
+	std::vector<std::uint64_t> remainderMasks;
+
+	static void setBit(std::vector<std::uint64_t>& masks,
+			const std::size_t offset, const int j) {
+		masks[offset + (j >> 6)] |= std::uint64_t(1) << (j & 63);
+	}
+
+public:
+
+	/**
+	 * Build the masks of an nQubits FenwickTree.
+	 *
+	 * @param nQubits The number of qubits
+	 */
+	FenwickMasks(const int nQubits) :
+			n(nQubits), nw((std::max(nQubits, 1) + 63) / 64),
+			updateMasks(nw * nQubits), parityMasks(nw * nQubits),
+			remainderMasks(nw * nQubits) {
+
+		// The same bisection FenwickTree uses, recording
+		// each index's parent and children
+		std::vector<int> parent(nQubits, -1);
+		std::vector<std::vector<int>> children(nQubits);
+		std::function<void(const int, const int, const int)> construct;
+		construct = [&](const int idx1, const int idx2, const int p) {
+			if (idx1 >= idx2) {
+				return;
+			}
+			auto pvt = (idx1 + idx2) >> 1;
+			parent[pvt] = p;
+			children[p].push_back(pvt);
+			construct(idx1, pvt, pvt);
+			construct(pvt + 1, idx2, p);
+		};
+		if (nQubits > 0) {
+			construct(0, nQubits - 1, nQubits - 1);
+		}
+
+		for (int i = 0; i < nQubits; i++) {
+			auto offset = i * nw;
+			for (auto a = parent[i]; a >= 0; a = parent[a]) {
+				setBit(updateMasks, offset, a);
+				for (auto c : children[a]) {
+					if (c < i) {
+						setBit(remainderMasks, offset, c);
+						setBit(parityMasks, offset, c);
+					}
+				}
+			}
+			for (auto c : children[i]) {
+				setBit(parityMasks, offset, c);
+			}
+		}
+	}
+
+	/**
+	 * Return the shared masks for nQubits qubits, building
+	 * them on first use.
+	 *
+	 * @param nQubits The number of qubits
+	 * @return masks The masks
+	 */
+	static std::shared_ptr<const FenwickMasks> get(const int nQubits) {
+		static std::mutex lock;
+		static std::map<int, std::shared_ptr<const FenwickMasks>> cache;
+		std::lock_guard<std::mutex> guard(lock);
+		auto& masks = cache[nQubits];
+		if (!masks) {
+			masks = std::make_shared<const FenwickMasks>(nQubits);
+		}
+		return masks;
+	}
+
+	int nQubits() const {
+		return n;
+	}
+
+	/**
+	 * Return the number of 64-bit words in each mask.
+	 */
+	std::size_t nWords() const {
+		return nw;
+	}
+
+	/**
+	 * Return the update set of index i, its ancestors.
+	 */
+	const std::uint64_t* update(const int i) const {
+		return updateMasks.data() + i * nw;
+	}
+
+	/**
+	 * Return the parity set of index i, the children of i
+	 * and the remainder set of i.
+	 */
+	const std::uint64_t* parity(const int i) const {
+		return parityMasks.data() + i * nw;
+	}
+
+	/**
+	 * Return the remainder set of index i, the children of
+	 * its ancestors below i.
+	 */
+	const std::uint64_t* remainder(const int i) const {
+		return remainderMasks.data() + i * nw;
+	}
+};
+
 
 #endif /* VQE_TRANSFORMATION_BK_FENWICK_HPP_ */
@@ -0,0 +1,457 @@
+/***********************************************************************************
+ * Copyright (c) 2017, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_TRANSFORMATION_ENCODING_LINEARENCODING_HPP_
+#define VQE_TRANSFORMATION_ENCODING_LINEARENCODING_HPP_
+
+#include "PauliOperator.hpp"
+#include "Fenwick.hpp"
+#include "XACC.hpp"
+#include <boost/algorithm/string.hpp>
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * A square matrix over GF(2), stored as rows of packed
+ * 64-bit words so that row operations and matrix vector
+ * products work on 64 columns at a time.
+ */
+class BinaryMatrix {
+
+protected:
+
+	int n;
+
+	std::size_t nw;
+
+	std::vector<std::uint64_t> bits;
+
+public:
+
+	BinaryMatrix() : n(0), nw(1) {
+	}
+
+	/**
+	 * Build the n x n zero matrix.
+	 *
+	 * @param size The number of rows and columns
+	 */
+	BinaryMatrix(const int size) :
+			n(size), nw((std::max(size, 1) + 63) / 64), bits(nw * size) {
+	}
+
+	static BinaryMatrix identity(const int size) {
+		BinaryMatrix m(size);
+		for (int i = 0; i < size; i++) {
+			m.set(i, i, true);
+		}
+		return m;
+	}
+
+	int size() const {
+		return n;
+	}
+
+	/**
+	 * Return the number of 64-bit words in each row.
+	 */
+	std::size_t nWords() const {
+		return nw;
+	}
+
+	const std::uint64_t* row(const int i) const {
+		return bits.data() + i * nw;
+	}
+
+	std::uint64_t* row(const int i) {
+		return bits.data() + i * nw;
+	}
+
+	bool get(const int i, const int j) const {
+		return (row(i)[j >> 6] >> (j & 63)) & 1;
+	}
+
+	void set(const int i, const int j, const bool value) {
+		auto bit = std::uint64_t(1) << (j & 63);
+		if (value) {
+			row(i)[j >> 6] |= bit;
+		} else {
+			row(i)[j >> 6] &= ~bit;
+		}
+	}
+
+	/**
+	 * Compute out = M v over GF(2), bit j of the packed
+	 * vector v being entry j.
+	 *
+	 * @param v The packed input vector, nWords() words
+	 * @param out The packed output vector, nWords() words
+	 */
+	void multiply(const std::uint64_t* v, std::uint64_t* out) const {
+		std::fill(out, out + nw, 0);
+		for (int i = 0; i < n; i++) {
+			auto r = row(i);
+			std::uint64_t p = 0;
+			for (std::size_t w = 0; w < nw; w++) {
+				p ^= r[w] & v[w];
+			}
+			out[i >> 6] |= std::uint64_t(__builtin_parityll(p)) << (i & 63);
+		}
+	}
+
+	BinaryMatrix transpose() const {
+		BinaryMatrix t(n);
+		for (int i = 0; i < n; i++) {
+			for (int j = 0; j < n; j++) {
+				if (get(i, j)) {
+					t.set(j, i, true);
+				}
+			}
+		}
+		return t;
+	}
+
+	/**
+	 * Return the inverse of this matrix by Gauss-Jordan
+	 * elimination, each row operation a run of word XORs.
+	 * Singular matrices are an error.
+	 */
+	BinaryMatrix inverse() const {
+		BinaryMatrix a(*this), inv = identity(n);
+		for (int c = 0; c < n; c++) {
+			int pivot = c;
+			while (pivot < n && !a.get(pivot, c)) {
+				pivot++;
+			}
+			if (pivot == n) {
+				xacc::error("Binary encoding matrix is not invertible.");
+			}
+			if (pivot != c) {
+				std::swap_ranges(a.row(c), a.row(c) + nw, a.row(pivot));
+				std::swap_ranges(inv.row(c), inv.row(c) + nw, inv.row(pivot));
+			}
+			for (int r = 0; r < n; r++) {
+				if (r != c && a.get(r, c)) {
+					for (std::size_t w = 0; w < nw; w++) {
+						a.row(r)[w] ^= a.row(c)[w];
+						inv.row(r)[w] ^= inv.row(c)[w];
+					}
+				}
+			}
+		}
+		return inv;
+	}
+
+	bool operator==(const BinaryMatrix& other) const {
+		return n == other.n && bits == other.bits;
+	}
+};
+
+/**
+ * A LinearEncoding maps fermionic occupation numbers f to qubit
+ * states b = A f over GF(2) for an invertible binary matrix A.
+ * Jordan-Wigner, parity and Bravyi-Kitaev are all such encodings.
+ *
+ * For mode j it keeps three packed qubit masks: the update set U_j,
+ * column j of A, whose qubits flip with f_j; the occupation set F_j,
+ * row j of A^-1, whose parity is f_j; and the parity set P_j, the
+ * sum of the rows k < j of A^-1, whose parity is f_0 + ... + f_{j-1}.
+ * The ladder operators are then
+ *
+ * a_j^+ = X_U Z_P (1 + Z_F) / 2,  a_j = X_U Z_P (1 - Z_F) / 2.
+ */
+class LinearEncoding {
+
+protected:
+
+	BinaryMatrix encoder;
+
+	BinaryMatrix decoder;
+
+	std::vector<std::uint64_t> updateMasks;
+	std::vector<std::uint64_t> parityMasks;
+
+public:
+
+	/**
+	 * Build the encoding b = A f.
+	 *
+	 * @param matrix The invertible encoding matrix A
+	 */
+	LinearEncoding(const BinaryMatrix& matrix) :
+			encoder(matrix), decoder(matrix.inverse()) {
+		auto n = matrix.size();
+		auto nw = matrix.nWords();
+		auto columns = matrix.transpose();
+		updateMasks.assign(columns.row(0), columns.row(0) + nw * n);
+		parityMasks.assign(nw * n, 0);
+		for (int j = 1; j < n; j++) {
+			auto previous = parityMasks.data() + (j - 1) * nw;
+			auto current = parityMasks.data() + j * nw;
+			for (std::size_t w = 0; w < nw; w++) {
+				current[w] = previous[w] ^ decoder.row(j - 1)[w];
+			}
+		}
+	}
+
+	/**
+	 * The identity encoding, qubit j stores f_j.
+	 */
+	static LinearEncoding jordanWigner(const int nModes) {
+		return LinearEncoding(BinaryMatrix::identity(nModes));
+	}
+
+	/**
+	 * The parity encoding, qubit j stores f_0 + ... + f_j.
+	 */
+	static LinearEncoding parity(const int nModes) {
+		BinaryMatrix m(nModes);
+		for (int i = 0; i < nModes; i++) {
+			for (int j = 0; j <= i; j++) {
+				m.set(i, j, true);
+			}
+		}
+		return LinearEncoding(m);
+	}
+
+	/**
+	 * The Bravyi-Kitaev encoding, qubit j stores the parity of
+	 * mode j and of the modes whose update set contains j, on
+	 * the same Fenwick tree the bk transformation uses.
+	 */
+	static LinearEncoding bravyiKitaev(const int nModes) {
+		auto masks = FenwickMasks::get(nModes);
+		BinaryMatrix m(nModes);
+		for (int k = 0; k < nModes; k++) {
+			m.set(k, k, true);
+			for (int i = 0; i < nModes; i++) {
+				if ((masks->update(k)[i >> 6] >> (i & 63)) & 1) {
+					m.set(i, k, true);
+				}
+			}
+		}
+		return LinearEncoding(m);
+	}
+
+	/**
+	 * The parity encoding applied within consecutive segments
+	 * of segmentSize modes, Jordan-Wigner strings only
+	 * running between segments.
+	 */
+	static LinearEncoding segment(const int nModes, const int segmentSize) {
+		if (segmentSize < 1) {
+			xacc::error("Invalid linear encoding segment size.");
+		}
+		BinaryMatrix m(nModes);
+		for (int i = 0; i < nModes; i++) {
+			for (int j = i - i % segmentSize; j <= i; j++) {
+				m.set(i, j, true);
+			}
+		}
+		return LinearEncoding(m);
+	}
+
+	/**
+	 * Build the encoding from its rows, given as strings of
+	 * 0 and 1 separated by commas or semicolons, character j
+	 * of row i being A_ij.
+	 */
+	static LinearEncoding fromRows(const std::string& rows) {
+		std::vector<std::string> split;
+		boost::split(split, rows, boost::is_any_of(",;"));
+		for (auto& r : split) {
+			boost::trim(r);
+		}
+		split.erase(std::remove(split.begin(), split.end(), ""), split.end());
+
+		int n = split.size();
+		BinaryMatrix m(n);
+		for (int i = 0; i < n; i++) {
+			if (split[i].size() != n || split[i].find_first_not_of("01")
+					!= std::string::npos) {
+				xacc::error("Invalid linear encoding matrix row " + split[i]);
+			}
+			for (int j = 0; j < n; j++) {
+				m.set(i, j, split[i][j] == '1');
+			}
+		}
+		return LinearEncoding(m);
+	}
+
+	/**
+	 * Return the rows of the encoding in the form fromRows reads.
+	 */
+	std::string toString() const {
+		std::string rows;
+		for (int i = 0; i < encoder.size(); i++) {
+			rows += i ? "," : "";
+			for (int j = 0; j < encoder.size(); j++) {
+				rows += encoder.get(i, j) ? '1' : '0';
+			}
+		}
+		return rows;
+	}
+
+	/**
+	 * Return the encoding named by the linear-encoding option,
+	 * jw, parity, bk, segment or custom, the last two reading
+	 * linear-encoding-segment-size and linear-encoding-matrix.
+	 */
+	static LinearEncoding fromOptions(const int nModes) {
+		auto name = xacc::optionExists("linear-encoding") ?
+				xacc::getOption("linear-encoding") : "parity";
+		if (name == "jw") {
+			return jordanWigner(nModes);
+		} else if (name == "parity") {
+			return parity(nModes);
+		} else if (name == "bk") {
+			return bravyiKitaev(nModes);
+		} else if (name == "segment") {
+			return segment(nModes,
+					xacc::optionExists("linear-encoding-segment-size") ?
+							std::stoi(xacc::getOption("linear-encoding-segment-size")) : 2);
+		} else if (name == "custom") {
+			if (!xacc::optionExists("linear-encoding-matrix")) {
+				xacc::error("The custom linear encoding requires linear-encoding-matrix.");
+			}
+			auto encoding = fromRows(xacc::getOption("linear-encoding-matrix"));
+			if (encoding.nModes() != nModes) {
+				xacc::error("linear-encoding-matrix must be " + std::to_string(nModes)
+								+ " x " + std::to_string(nModes) + ".");
+			}
+			return encoding;
+		}
+		xacc::error("Invalid linear encoding " + name);
+		return jordanWigner(nModes);
+	}
+
+	int nModes() const {
+		return encoder.size();
+	}
+
+	std::size_t nWords() const {
+		return encoder.nWords();
+	}
+
+	const BinaryMatrix& getEncoder() const {
+		return encoder;
+	}
+
+	const BinaryMatrix& getDecoder() const {
+		return decoder;
+	}
+
+	/**
+	 * Return the update set of mode j, the qubits flipped
+	 * when f_j changes.
+	 */
+	const std::uint64_t* updateSet(const int j) const {
+		return updateMasks.data() + j * nWords();
+	}
+
+	/**
+	 * Return the parity set of mode j, the qubits whose
+	 * parity is that of the modes below j.
+	 */
+	const std::uint64_t* paritySet(const int j) const {
+		return parityMasks.data() + j * nWords();
+	}
+
+	/**
+	 * Return the occupation set of mode j, the qubits
+	 * whose parity is f_j.
+	 */
+	const std::uint64_t* occupationSet(const int j) const {
+		return decoder.row(j);
+	}
+
+	/**
+	 * Map packed occupation numbers to packed qubit states.
+	 */
+	void encode(const std::uint64_t* occupations, std::uint64_t* qubits) const {
+		encoder.multiply(occupations, qubits);
+	}
+
+	/**
+	 * Map packed qubit states back to occupation numbers.
+	 */
+	void decode(const std::uint64_t* qubits, std::uint64_t* occupations) const {
+		decoder.multiply(qubits, occupations);
+	}
+
+	std::uint64_t encode(std::uint64_t occupations) const {
+		std::vector<std::uint64_t> in(nWords()), out(nWords());
+		in[0] = occupations;
+		encode(in.data(), out.data());
+		return out[0];
+	}
+
+	std::uint64_t decode(std::uint64_t qubits) const {
+		std::vector<std::uint64_t> in(nWords()), out(nWords());
+		in[0] = qubits;
+		decode(in.data(), out.data());
+		return out[0];
+	}
+
+	/**
+	 * Return the image of a_j^+, or of a_j if creation is false.
+	 * Both Pauli strings share X on U_j, with Z on P_j and on
+	 * P_j + F_j, every qubit with both X and Z contributing -i.
+	 */
+	PauliOperator ladder(const int j, const bool creation) const {
+		auto nw = nWords();
+		std::vector<std::uint64_t> xs(updateSet(j), updateSet(j) + nw),
+				cz(paritySet(j), paritySet(j) + nw), dz(nw);
+		int cy = 0, dy = 0;
+		for (std::size_t w = 0; w < nw; w++) {
+			dz[w] = cz[w] ^ occupationSet(j)[w];
+			cy += __builtin_popcountll(xs[w] & cz[w]);
+			dy += __builtin_popcountll(xs[w] & dz[w]);
+		}
+
+		// Half of (-i)^k, a_j negating the second string
+		static const std::complex<double> phases[] = { { .5, 0 }, { 0, -.5 },
+				{ -.5, 0 }, { 0, .5 } };
+		PauliOperator op;
+		op.addTerm(Term(phases[cy & 3], "",
+						PauliString(xs.data(), cz.data(), nw)));
+		op.addTerm(Term(phases[(dy + (creation ? 0 : 2)) & 3], "",
+						PauliString(xs.data(), dz.data(), nw)));
+		return op;
+	}
+};
+
+}
+
+}
+
+#endif
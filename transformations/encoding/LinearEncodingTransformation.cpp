@@ -0,0 +1,34 @@
+#include "LinearEncodingTransformation.hpp"
+#include "XACC.hpp"
+
+namespace xacc {
+namespace vqe {
+
+PauliOperator LinearEncodingTransformation::transform(FermionKernel& kernel) {
+	result.clear();
+
+	int nQubits = std::stoi(xacc::getOption("n-qubits"));
+	fermionKernel = std::make_shared<FermionKernel>(kernel);
+
+	// The images of a_i^+ and a_i, read once from the packed
+	// rows of the encoding and its inverse
+	auto encoding = getEncoding(nQubits);
+	std::vector<PauliOperator> creation, annihilation;
+	for (int i = 0; i < nQubits; i++) {
+		creation.push_back(encoding.ladder(i, true));
+		annihilation.push_back(encoding.ladder(i, false));
+	}
+
+	mapLadderProducts(kernel, creation, annihilation);
+
+	return result;
+}
+
+std::shared_ptr<IR> LinearEncodingTransformation::transform(
+		std::shared_ptr<IR> ir) {
+	auto fermiKernel = ir->getKernels()[0];
+	return transform(*std::dynamic_pointer_cast<FermionKernel>(fermiKernel)).toXACCIR();
+}
+
+}
+}
@@ -0,0 +1,81 @@
+/***********************************************************************************
+ * Copyright (c) 2017, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_LinearEncodingTransformation_HPP_
+#define VQE_IR_LinearEncodingTransformation_HPP_
+
+#include "FermionToSpinTransformation.hpp"
+#include "LinearEncoding.hpp"
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The LinearEncodingTransformation maps fermion kernels to spin
+ * hamiltonians under any LinearEncoding, by default the one
+ * selected with the linear-encoding option.
+ */
+class LinearEncodingTransformation: public FermionToSpinTransformation {
+
+protected:
+
+	/**
+	 * Return the encoding of nQubits modes to map with.
+	 */
+	virtual LinearEncoding getEncoding(const int nQubits) {
+		return LinearEncoding::fromOptions(nQubits);
+	}
+
+public:
+
+	virtual std::shared_ptr<IR> transform(std::shared_ptr<IR> ir);
+	virtual PauliOperator transform(FermionKernel& kernel);
+
+	virtual std::string cacheKey(const int nQubits) {
+		return name() + ":" + getEncoding(nQubits).toString();
+	}
+
+	virtual const std::string name() const {
+		return "linear-encoding";
+	}
+
+	virtual const std::string description() const {
+		return "Map fermions to qubits under a binary encoding matrix, "
+				"jw, parity, bk, segment or custom, chosen with linear-encoding.";
+	}
+
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "DirectJW.hpp"
+#include "XACC.hpp"
+
+namespace xacc {
+namespace vqe {
+
+void DirectJW::addTerm(const std::int32_t* sites, const int n,
+		const std::uint32_t creationMask, const std::complex<double> coeff,
+		const std::string& var, PauliOperator& op) {
+
+	static const std::complex<double> phases[] = { { 1, 0 }, { 0, 1 },
+			{ -1, 0 }, { 0, -1 } };
+
+	std::uint32_t nWords = 1;
+	for (int i = 0; i < n; i++) {
+		nWords = std::max<std::uint32_t>(nWords, (sites[i] >> 6) + 1);
+	}
+	std::vector<std::uint64_t> xs(nWords), zs(nWords);
+
+	// Product m picks Y for ladder operator i if bit n-1-i of m is
+	// set, and X otherwise. Counting m up visits the products in the
+	// order a depth first expansion of the ladder operators does
+	for (std::uint64_t m = 0; m < (std::uint64_t(1) << n); m++) {
+		std::fill(xs.begin(), xs.end(), 0);
+		std::fill(zs.begin(), zs.end(), 0);
+		auto c = std::complex<double>(1, 0) * coeff;
+
+		for (int i = 0; i < n; i++) {
+			bool y = (m >> (n - 1 - i)) & 1;
+			auto p = sites[i];
+			std::uint32_t w = p >> 6;
+			auto bit = std::uint64_t(1) << (p & 63);
+
+			// Multiplying by Z_0...Z_{p-1} gives i for every Y and -i
+			// for every X below p, then X_p or Y_p acts on site p
+			int plus = 0, minus = 0;
+			for (std::uint32_t j = 0; j <= w; j++) {
+				auto low = j < w ? ~std::uint64_t(0) : bit - 1;
+				plus += __builtin_popcountll(xs[j] & zs[j] & low);
+				minus += __builtin_popcountll(xs[j] & ~zs[j] & low);
+			}
+			bool xp = xs[w] & bit, zp = zs[w] & bit;
+			if (y) {
+				plus += xp && !zp;
+				minus += !xp && zp;
+				c *= std::complex<double>(0,
+						((creationMask >> i) & 1) ? -.5 : .5);
+			} else {
+				plus += !xp && zp;
+				minus += xp && zp;
+				c *= std::complex<double>(.5, 0);
+			}
+			auto k = (plus + 3 * minus) & 3;
+			if (k) {
+				c *= phases[k];
+			}
+
+			for (std::uint32_t j = 0; j < w; j++) {
+				zs[j] = ~zs[j];
+			}
+			zs[w] ^= bit - 1;
+			xs[w] ^= bit;
+			if (y) {
+				zs[w] ^= bit;
+			}
+		}
+
+		op.addTerm(Term(c, var, PauliString(xs.data(), zs.data(), nWords)));
+	}
+}
+
+PauliOperator DirectJW::transform(FermionKernel& kernel) {
+	result.clear();
+
+	fermionKernel = std::make_shared<FermionKernel>(kernel);
+
+	// Map each distinct normal ordered term once, its hermitian
+	// conjugate maps to the adjoint of the same image
+	std::vector<std::complex<double>> conjugates;
+	auto fermions = kernel.getOperator().normalOrdered(&conjugates);
+
+	mapTerms(fermions.nTerms(),
+			[&](const std::size_t begin, const std::size_t end, PauliOperator& op) {
+		PauliOperator image;
+		for (std::size_t z = begin; z < end; ++z) {
+			auto& coeff = fermions.coeff(z);
+			auto& conjugate = conjugates[z];
+			auto& var = fermions.var(z);
+
+			if (conjugate == 0.0) {
+				addTerm(fermions.sites(z), fermions.nOperators(z),
+						fermions.creationMask(z), coeff, var, op);
+				continue;
+			}
+
+			image.clear();
+			addTerm(fermions.sites(z), fermions.nOperators(z),
+					fermions.creationMask(z), 1.0, var, image);
+			image.forEachTerm([&](const Term& t) {
+				op.addTerm(Term(std::conj(t.coeff()) * conjugate, var,
+						t.pauliString()));
+			});
+			if (coeff != 0.0) {
+				image.forEachTerm([&](const Term& t) {
+					op.addTerm(Term(t.coeff() * coeff, var, t.pauliString()));
+				});
+			}
+		}
+	});
+
+	return result;
+}
+
+std::shared_ptr<IR> DirectJW::transform(std::shared_ptr<IR> ir) {
+	auto fermiKernel = ir->getKernels()[0];
+	return transform(*std::dynamic_pointer_cast<FermionKernel>(fermiKernel)).toXACCIR();
+}
+
+}
+}
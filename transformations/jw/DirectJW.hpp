@@ -0,0 +1,95 @@
+/***********************************************************************************
+ * Copyright (c) 2018, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_DIRECTJW_HPP_
+#define VQE_IR_DIRECTJW_HPP_
+
+#include "FermionToSpinTransformation.hpp"
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * DirectJW is a Jordan-Wigner transformation that writes the
+ * Pauli strings of each fermion term straight from its site
+ * pattern. Ladder operator k of a term contributes
+ * Z_0...Z_{p-1} X_p / 2 or Z_0...Z_{p-1} Y_p (-+i / 2), so every
+ * string of the product and its phase follows from bit operations
+ * on the packed symplectic words, and is added to the result with
+ * no intermediate PauliOperators. Strings are emitted and summed
+ * in the same order as the jw transformation expands its products,
+ * so the results are bit-identical to jw.
+ */
+class DirectJW: public FermionToSpinTransformation {
+
+public:
+
+	/**
+	 * Transform a FermionIR instance to a GateQIR instance.
+	 *
+	 * @param ir
+	 * @return
+	 */
+	virtual std::shared_ptr<IR> transform(std::shared_ptr<IR> ir);
+	virtual PauliOperator transform(FermionKernel& kernel);
+
+	virtual const std::string name() const {
+		return "direct-jw";
+	}
+
+	virtual const std::string description() const {
+		return "The direct Jordan-Wigner IR Transformation emits the Pauli "
+				"strings of each fermionic term in closed form.";
+	}
+
+	/**
+	 * Add coeff * var * a_{sites[0]} ... a_{sites[n-1]}, under the
+	 * Jordan-Wigner mapping, to op. Bit k of creationMask is set
+	 * if ladder operator k is a creation operator.
+	 *
+	 * @param sites The n operator sites
+	 * @param n The number of ladder operators
+	 * @param creationMask The creation operator bits
+	 * @param coeff The term coefficient
+	 * @param var The term variable, or empty
+	 * @param op The operator to add to
+	 */
+	static void addTerm(const std::int32_t* sites, const int n,
+			const std::uint32_t creationMask, const std::complex<double> coeff,
+			const std::string& var, PauliOperator& op);
+
+};
+
+}
+
+}
+
+#endif
@@ -5,55 +5,28 @@ namespace xacc {
 namespace vqe {
 
 PauliOperator JordanWignerIRTransformation::transform(FermionKernel& kernel) {
-	int myStart = 0;
-	int myEnd = kernel.nInstructions();
-
 	result.clear();
 
 	fermionKernel = std::make_shared<FermionKernel>(kernel);
 
-	auto instructions = kernel.getInstructions();
-	auto instVec = std::vector<InstPtr>(instructions.begin(), instructions.end());
-
-	auto start = std::clock();
-
-	// Loop over all Fermionic terms...
-	for (int z = myStart; z < myEnd; ++z) {
-
-		auto f = instVec[z];
-
-		// Get the creation or annihilation sites
-		auto termSites = f->bits();
-
-		// Get the params indicating if termSite is creation or annihilation
-		auto params = f->getParameters();
-
-		auto coeff = boost::get<std::complex<double>>(params[f->nParameters() - 2]);
-		auto fermionVar = boost::get<std::string>(params[f->nParameters() - 1]);
-
-		PauliOperator current(coeff, fermionVar);
-		for (int i = 0; i < termSites.size(); i++) {
-			std::map<int, std::string> zs;
-			auto isCreation = boost::get<int>(params[i]);
-
-			int index = termSites[i];
-
-			std::complex<double> ycoeff =
-					isCreation ?
-							std::complex<double>(0, -.5) :
-							std::complex<double>(0, .5), xcoeff(.5, 0);
-
-			for (int j = 0; j < index; j++) zs.emplace(std::make_pair(j,"Z"));
-
-			current *= PauliOperator(zs)
-					* (PauliOperator( { { index, "X" } }, xcoeff)
-							+ PauliOperator( { { index, "Y" } }, ycoeff));
-		}
-
-		result += current;
+	// The images of a_i^+ and a_i, built once per mode
+	std::vector<PauliOperator> creation, annihilation;
+	for (int index = 0; index <= kernel.getOperator().maxSite(); index++) {
+		std::map<int, std::string> zs;
+		for (int j = 0; j < index; j++) zs.emplace(std::make_pair(j,"Z"));
+
+		std::complex<double> xcoeff(.5, 0);
+		creation.push_back(PauliOperator(zs)
+				* (PauliOperator( { { index, "X" } }, xcoeff)
+						+ PauliOperator( { { index, "Y" } },
+								std::complex<double>(0, -.5))));
+		annihilation.push_back(PauliOperator(zs)
+				* (PauliOperator( { { index, "X" } }, xcoeff)
+						+ PauliOperator( { { index, "Y" } },
+								std::complex<double>(0, .5))));
 	}
 
-//	std::cout << (std::clock() - start) / (double) (CLOCKS_PER_SEC) << "\n";
+	mapLadderProducts(kernel, creation, annihilation);
 
 	return result;
 }
@@ -12,60 +12,55 @@ std::shared_ptr<IR> LongRangeJW::transform(
 	auto fermiKernel = ir->getKernels()[0];
 
 	result.clear();
+	fermionKernel = std::dynamic_pointer_cast<FermionKernel>(fermiKernel);
 
-	int myStart = 0;
-	int myEnd = fermiKernel->nInstructions();
-
-	auto instructions = fermiKernel->getInstructions();
-	auto instVec = std::vector<InstPtr>(instructions.begin(), instructions.end());
+	auto& fermions = fermionKernel->getOperator();
 
 	auto start = std::clock();
-	// Loop over all Fermionic terms...
-	for (int z = myStart; z < myEnd; ++z) {
-
-		auto f = instVec[z];
-
-		auto coeff = boost::get<std::complex<double>>(
-				f->getParameter(f->nParameters() - 2));
+	mapTerms(fermions.nTerms(),
+			[&](const std::size_t begin, const std::size_t end, PauliOperator& op) {
+		for (std::size_t z = begin; z < end; ++z) {
 
-		auto fermionVar = boost::get<std::string>(f->getParameter(f->nParameters() - 1));
+			auto& coeff = fermions.coeff(z);
 
-		// Get the creation or annihilation sites
-		auto termSites = f->bits();
+			// Get the creation or annihilation sites
+			auto termSites = fermions.sites(z);
+			auto nSites = fermions.nOperators(z);
 
-		if (termSites.size() == 2) {
+			if (nSites == 2) {
 
-			int i = termSites[0];
-			int j = termSites[1];
-			PauliOperator Sxi({{i,"X"}}, 0.5), Syi({{i,"Y"}}, 0.5);
-			PauliOperator Sxj({{j,"X"}}, 0.5), Syj({{j,"Y"}}, 0.5);
-			PauliOperator sPlusI = Sxi - imag * Syi;
-			PauliOperator sMinusJ = Sxj + imag * Syj;
+				int i = termSites[0];
+				int j = termSites[1];
+				PauliOperator Sxi({{i,"X"}}, 0.5), Syi({{i,"Y"}}, 0.5);
+				PauliOperator Sxj({{j,"X"}}, 0.5), Syj({{j,"Y"}}, 0.5);
+				PauliOperator sPlusI = Sxi - imag * Syi;
+				PauliOperator sMinusJ = Sxj + imag * Syj;
 
-			result += coeff * sPlusI * sMinusJ;
+				op.addProduct(coeff, {sPlusI, sMinusJ});
 
-		} else if (termSites.size() == 4) {
-			int i = termSites[0];
-			int j = termSites[1];
-			int k = termSites[2];
-			int l = termSites[3];
+			} else if (nSites == 4) {
+				int i = termSites[0];
+				int j = termSites[1];
+				int k = termSites[2];
+				int l = termSites[3];
 
 
-			PauliOperator Sxi({{i,"X"}}, 0.5), Syi({{i,"Y"}}, 0.5);
-			PauliOperator Sxj({{j,"X"}}, 0.5), Syj({{j,"Y"}}, 0.5);
-			PauliOperator Sxk({{k,"X"}}, 0.5), Syk({{k,"Y"}}, 0.5);
-			PauliOperator Sxl({{l,"X"}}, 0.5), Syl({{l,"Y"}}, 0.5);
+				PauliOperator Sxi({{i,"X"}}, 0.5), Syi({{i,"Y"}}, 0.5);
+				PauliOperator Sxj({{j,"X"}}, 0.5), Syj({{j,"Y"}}, 0.5);
+				PauliOperator Sxk({{k,"X"}}, 0.5), Syk({{k,"Y"}}, 0.5);
+				PauliOperator Sxl({{l,"X"}}, 0.5), Syl({{l,"Y"}}, 0.5);
 
-			PauliOperator sPlusI = Sxi - imag * Syi;
-			PauliOperator sPlusJ = Sxj - imag * Syj;
-			PauliOperator sMinusK = Sxk + imag * Syk;
-			PauliOperator sMinusL = Sxl + imag * Syl;
+				PauliOperator sPlusI = Sxi - imag * Syi;
+				PauliOperator sPlusJ = Sxj - imag * Syj;
+				PauliOperator sMinusK = Sxk + imag * Syk;
+				PauliOperator sMinusL = Sxl + imag * Syl;
 
-			result += coeff * sPlusI * sPlusJ * sMinusK * sMinusL;
-		} else if (termSites.size() == 0) {
-			result += PauliOperator(coeff);
+				op.addProduct(coeff, {sPlusI, sPlusJ, sMinusK, sMinusL});
+			} else if (nSites == 0) {
+				op += PauliOperator(coeff);
+			}
 		}
-	}
+	});
 
 	std::cout << (std::clock() - start) / (double) (CLOCKS_PER_SEC) << "\n";
 	return result.toXACCIR();
@@ -0,0 +1,71 @@
+#include "TernaryTreeTransformation.hpp"
+#include "XACC.hpp"
+
+namespace xacc {
+namespace vqe {
+
+PauliOperator TernaryTreeTransformation::ladder(const int nModes,
+		const int j, const bool creation) {
+	std::size_t nWords = (std::max(nModes, 1) + 63) / 64;
+	std::vector<std::uint64_t> xs(nWords), zs(nWords);
+	auto set = [](std::vector<std::uint64_t>& mask, const int q) {
+		mask[q >> 6] |= std::uint64_t(1) << (q & 63);
+	};
+
+	// The path from the root down to j, each ancestor acting
+	// with the Pauli of the branch taken
+	for (int k = j; k > 0; k = (k - 1) / 3) {
+		auto parent = (k - 1) / 3, branch = (k - 1) % 3;
+		if (branch != 2) {
+			set(xs, parent);
+		}
+		if (branch != 0) {
+			set(zs, parent);
+		}
+	}
+
+	// X on j and Z down from its X child, or Y on j
+	// and Z down from its Y child
+	set(xs, j);
+	std::vector<std::uint64_t> xz(zs), yz(zs);
+	set(yz, j);
+	for (int k = 3 * j + 1; k < nModes; k = 3 * k + 3) {
+		set(xz, k);
+	}
+	for (int k = 3 * j + 2; k < nModes; k = 3 * k + 3) {
+		set(yz, k);
+	}
+
+	PauliOperator op;
+	op.addTerm(Term(std::complex<double>(.5, 0), "",
+					PauliString(xs.data(), xz.data(), nWords)));
+	op.addTerm(Term(std::complex<double>(0, creation ? -.5 : .5), "",
+					PauliString(xs.data(), yz.data(), nWords)));
+	return op;
+}
+
+PauliOperator TernaryTreeTransformation::transform(FermionKernel& kernel) {
+	result.clear();
+
+	int nQubits = std::stoi(xacc::getOption("n-qubits"));
+	fermionKernel = std::make_shared<FermionKernel>(kernel);
+
+	std::vector<PauliOperator> creation, annihilation;
+	for (int i = 0; i < nQubits; i++) {
+		creation.push_back(ladder(nQubits, i, true));
+		annihilation.push_back(ladder(nQubits, i, false));
+	}
+
+	mapLadderProducts(kernel, creation, annihilation);
+
+	return result;
+}
+
+std::shared_ptr<IR> TernaryTreeTransformation::transform(
+		std::shared_ptr<IR> ir) {
+	auto fermiKernel = ir->getKernels()[0];
+	return transform(*std::dynamic_pointer_cast<FermionKernel>(fermiKernel)).toXACCIR();
+}
+
+}
+}
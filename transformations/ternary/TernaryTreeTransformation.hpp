@@ -0,0 +1,86 @@
+/***********************************************************************************
+ * Copyright (c) 2017, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#ifndef VQE_IR_TernaryTreeTransformation_HPP_
+#define VQE_IR_TernaryTreeTransformation_HPP_
+
+#include "FermionToSpinTransformation.hpp"
+
+namespace xacc {
+
+namespace vqe {
+
+/**
+ * The TernaryTreeTransformation maps N fermionic modes to N qubits
+ * arranged as a complete ternary tree, qubit k having children
+ * 3k+1, 3k+2 and 3k+3 reached by X, Y and Z. Each root to leaf
+ * path is a Pauli string, and any two of them anticommute, so they
+ * serve as Majorana operators of Pauli weight O(log_3 N), the
+ * optimum for any fermion to qubit mapping.
+ *
+ * Mode j pairs the path taking X at qubit j with the one taking Y,
+ * both continuing down Z branches, so that |0...0> is the vacuum.
+ * The all-Z path from the root is the one left over.
+ */
+class TernaryTreeTransformation: public FermionToSpinTransformation {
+
+public:
+
+	/**
+	 * Return the image of a_j^+, or of a_j if creation is
+	 * false, under the nModes ternary tree mapping.
+	 *
+	 * @param nModes The number of modes
+	 * @param j The mode
+	 * @param creation True for a_j^+
+	 * @return op The image, (M_X -+ i M_Y) / 2
+	 */
+	static PauliOperator ladder(const int nModes, const int j,
+			const bool creation);
+
+	virtual std::shared_ptr<IR> transform(std::shared_ptr<IR> ir);
+	virtual PauliOperator transform(FermionKernel& kernel);
+
+	virtual const std::string name() const {
+		return "ternary-tree";
+	}
+
+	virtual const std::string description() const {
+		return "Map fermions to qubits along the paths of a ternary tree, "
+				"with O(log_3 N) Pauli weight.";
+	}
+
+};
+
+}
+
+}
+
+#endif
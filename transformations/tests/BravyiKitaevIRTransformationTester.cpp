@@ -30,6 +30,7 @@
  **********************************************************************************/
 #include <gtest/gtest.h>
 #include "BravyiKitaevIRTransformation.hpp"
+#include "JordanWignerIRTransformation.hpp"
 #include "XACC.hpp"
 
 using namespace xacc::vqe;
@@ -174,6 +175,68 @@ TEST(BravyiKitaevIRTransformationTester,checkH2Transform) {
 
 }
 
+TEST(BravyiKitaevIRTransformationTester,checkLinearEncodings) {
+
+	// Every encoding must give ladder operators obeying the
+	// anticommutation relations, and decode what it encodes
+	std::vector<LinearEncoding> encodings { LinearEncoding::jordanWigner(5),
+			LinearEncoding::parity(5), LinearEncoding::bravyiKitaev(5),
+			LinearEncoding::segment(5, 2),
+			LinearEncoding::fromRows("10000,11000,01100,00010,10111") };
+	for (auto& encoding : encodings) {
+		for (int i = 0; i < 5; i++) {
+			for (int j = 0; j < 5; j++) {
+				auto ai = encoding.ladder(i, false), aj = encoding.ladder(j, false);
+				auto ajDag = encoding.ladder(j, true);
+				EXPECT_TRUE(ai * ajDag + ajDag * ai == (i == j ? PauliOperator(1.0) : PauliOperator()));
+				EXPECT_TRUE(ai * aj + aj * ai == PauliOperator());
+			}
+		}
+		for (std::uint64_t f = 0; f < 32; f++) {
+			EXPECT_EQ(f, encoding.decode(encoding.encode(f)));
+		}
+	}
+
+	EXPECT_EQ(0b00011, LinearEncoding::parity(5).encode(0b00101));
+	EXPECT_EQ(0b1101, LinearEncoding::bravyiKitaev(4).encode(0b0111));
+	EXPECT_TRUE(LinearEncoding::parity(5).getEncoder()
+			== LinearEncoding::segment(5, 5).getEncoder());
+
+	// The engine reproduces the bk and jw transformations
+	xacc::setOption("n-qubits", "3");
+	auto kernel = std::make_shared<FermionKernel>("foo");
+	kernel->addInstruction(std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 2, 1 }, { 0, 0 }}, 3.17));
+	kernel->addInstruction(std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 0, 1 }, { 2, 0 }}, 3.17));
+	kernel->addInstruction(std::make_shared<FermionInstruction>(
+			std::vector<std::pair<int, int>> { { 1, 1 }, { 1, 0 }}, -.5));
+
+	LinearEncodingTransformation linear;
+	BravyiKitaevIRTransformation bk;
+	JordanWignerIRTransformation jw;
+	xacc::setOption("linear-encoding", "bk");
+	EXPECT_TRUE(linear.transform(*kernel) == bk.transform(*kernel));
+	xacc::setOption("linear-encoding", "jw");
+	EXPECT_TRUE(linear.transform(*kernel) == jw.transform(*kernel));
+
+	// Under parity a_0^+ a_2 + h.c. flips qubits 0 and 1
+	xacc::setOption("linear-encoding", "parity");
+	PauliOperator expected({{0,"X"}, {1,"X"}, {2,"Z"}}, -1.585);
+	expected += PauliOperator({{0,"Y"}, {1,"Y"}}, -1.585);
+	expected += PauliOperator({{0,"Z"}, {1,"Z"}}, .25);
+	expected += PauliOperator(-.25);
+	EXPECT_TRUE(expected == linear.transform(*kernel));
+
+	// Cached results are keyed by the encoding matrix
+	EXPECT_EQ("linear-encoding:100,110,111", linear.cacheKey(3));
+	EXPECT_EQ(LinearEncoding::fromRows(linear.cacheKey(3).substr(16))
+			.getEncoder(), LinearEncoding::parity(3).getEncoder());
+	xacc::setOption("linear-encoding", "jw");
+	EXPECT_EQ("linear-encoding:100,010,001", linear.cacheKey(3));
+	EXPECT_EQ("jw", jw.cacheKey(3));
+}
+
 int main(int argc, char** argv) {
    xacc::Initialize(argc,argv);
    ::testing::InitGoogleTest(&argc, argv);
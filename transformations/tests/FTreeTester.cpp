@@ -104,3 +104,35 @@ BOOST_AUTO_TEST_CASE(checkSimple) {
 
 }
 
+BOOST_AUTO_TEST_CASE(checkMasks) {
+
+	auto inMask = [](const std::uint64_t* mask, const int j) {
+		return bool((mask[j >> 6] >> (j & 63)) & 1);
+	};
+
+	for (int n : { 1, 8, 13, 64, 100 }) {
+		FenwickTree f(n);
+		auto masks = FenwickMasks::get(n);
+		BOOST_VERIFY(masks == FenwickMasks::get(n));
+		BOOST_VERIFY(masks->nWords() == (n + 63) / 64);
+
+		for (int i = 0; i < n; i++) {
+			std::set<int> update, parity, remainder;
+			for (auto& node : f.getUpdateSet(i)) {
+				update.insert(node->index);
+			}
+			for (auto& node : f.getParitySet(i)) {
+				parity.insert(node->index);
+			}
+			for (auto& node : f.getRemainderSet(i)) {
+				remainder.insert(node->index);
+			}
+
+			for (int j = 0; j < n; j++) {
+				BOOST_VERIFY(inMask(masks->update(i), j) == update.count(j));
+				BOOST_VERIFY(inMask(masks->parity(i), j) == parity.count(j));
+				BOOST_VERIFY(inMask(masks->remainder(i), j) == remainder.count(j));
+			}
+		}
+	}
+}
@@ -30,8 +30,10 @@
  **********************************************************************************/
 #include <gtest/gtest.h>
 #include "JordanWignerIRTransformation.hpp"
+#include "DirectJW.hpp"
 #include "XACC.hpp"
 #include "EfficientJW.cpp"
+#include <random>
 
 using namespace xacc::vqe;
 
@@ -260,6 +262,111 @@ TEST(JordanWignerTransformationTester,checkEfficientJW) {
 
 }
 
+TEST(JordanWignerTransformationTester,checkDirectJW) {
+
+	// Random one and two body terms, in and out of normal order,
+	// with hermitian pairs, repeated sites, variables and sites
+	// past the first 64 qubit word
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> site(0, 69), nOps(0, 2);
+	std::uniform_real_distribution<double> coeff(-1.0, 1.0);
+	auto kernel = std::make_shared<FermionKernel>("random");
+	auto& op = kernel->getOperator();
+	for (int i = 0; i < 200; i++) {
+		std::vector<std::pair<int, int>> ops;
+		auto n = nOps(gen);
+		for (int k = 0; k < 2 * n; k++) {
+			ops.push_back( { i % 4 ? site(gen) % 8 : site(gen), k < n });
+		}
+		std::string var = i % 5 ? "" : "theta" + std::to_string(i % 2);
+		op.addTerm(ops, std::complex<double>(coeff(gen), i % 7 ? 0.0 : coeff(gen)), var);
+		if (i % 3 == 0) {
+			std::vector<std::pair<int, int>> adjoint(ops.rbegin(), ops.rend());
+			for (auto& a : adjoint) {
+				a.second = !a.second;
+			}
+			op.addTerm(adjoint, coeff(gen), var);
+		}
+	}
+
+	JordanWignerIRTransformation jw;
+	DirectJW direct;
+	auto expected = jw.transform(*kernel);
+	auto result = direct.transform(*kernel);
+	auto expectedTerms = expected.getTermView();
+	auto resultTerms = result.getTermView();
+	ASSERT_EQ(expectedTerms.size(), resultTerms.size());
+	for (std::size_t i = 0; i < expectedTerms.size(); i++) {
+		EXPECT_EQ(expectedTerms[i].id(), resultTerms[i].id());
+		EXPECT_EQ(expectedTerms[i].coeff(), resultTerms[i].coeff());
+	}
+}
+
+/**
+ * A Communicator standing in for one rank of a larger job,
+ * whose collectives leave every buffer as it is.
+ */
+class RankCommunicator : public Communicator {
+protected:
+	int r, n;
+public:
+	RankCommunicator(const int rank, const int nRanks) : r(rank), n(nRanks) {}
+	virtual const int rank() {
+		return r;
+	}
+	virtual const int size() {
+		return n;
+	}
+	virtual void broadcast(std::vector<double>& d, const int root) {
+	}
+	virtual void broadcast(std::string& d, const int root) {
+	}
+	virtual void sumDoubles(double& myVal, double& result) {
+		result = myVal;
+	}
+	virtual void sumInts(int& myVal, int& result) {
+		result = myVal;
+	}
+	virtual void maxDouble(double& myVal, double& result) {
+		result = myVal;
+	}
+	virtual void reduce(std::string& d,
+			const std::function<std::string(const std::string&,
+					const std::string&)>& op, const int root) {
+	}
+};
+
+TEST(JordanWignerTransformationTester,checkPartitionedTransform) {
+
+	std::mt19937 gen(11);
+	std::uniform_int_distribution<int> site(0, 11);
+	auto kernel = std::make_shared<FermionKernel>("random");
+	for (int i = 0; i < 3000; i++) {
+		kernel->getOperator().addTerm( { { site(gen), 1 }, { site(gen), 1 },
+				{ site(gen), 0 }, { site(gen), 0 } }, 0.01 * (i % 17 + 1));
+	}
+
+	auto nThreads = PauliOperator::getNumThreads();
+	JordanWignerIRTransformation jw;
+	PauliOperator::setNumThreads(1);
+	auto serial = jw.transform(*kernel);
+
+	// Each rank maps its share of the terms, over several threads
+	PauliOperator::setNumThreads(4);
+	PauliOperator sum;
+	for (int r = 0; r < 3; r++) {
+		jw.setCommunicator(std::make_shared<RankCommunicator>(r, 3));
+		auto part = jw.transform(*kernel);
+		EXPECT_FALSE(part == serial);
+		sum += part;
+	}
+	EXPECT_TRUE(sum == serial);
+
+	jw.setCommunicator(std::make_shared<RankCommunicator>(0, 1));
+	EXPECT_TRUE(jw.transform(*kernel) == serial);
+	PauliOperator::setNumThreads(nThreads);
+}
+
 int main(int argc, char** argv) {
    xacc::Initialize(argc,argv);
    ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,138 @@
+
+/***********************************************************************************
+ * Copyright (c) 2016, UT-Battelle
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the xacc nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributors:
+ *   Initial API and implementation - Alex McCaskey
+ *
+ **********************************************************************************/
+#include <gtest/gtest.h>
+#include "TernaryTreeTransformation.hpp"
+#include "JordanWignerIRTransformation.hpp"
+#include "XACC.hpp"
+#include <Eigen/Dense>
+#include <random>
+
+using namespace xacc::vqe;
+
+TEST(TernaryTreeTransformationTester,checkLadders) {
+
+	for (int n : { 1, 2, 4, 13, 14, 40, 70 }) {
+		std::vector<PauliOperator> creation, annihilation;
+		for (int j = 0; j < n; j++) {
+			creation.push_back(TernaryTreeTransformation::ladder(n, j, true));
+			annihilation.push_back(TernaryTreeTransformation::ladder(n, j, false));
+		}
+
+		// Every Majorana is a path of the tree, ceil(log_3(2n + 1)) long
+		int depth = 0;
+		for (int leaves = 1; leaves < 2 * n + 1; leaves *= 3) {
+			depth++;
+		}
+		for (auto& a : annihilation) {
+			for (auto& t : a.getTermView()) {
+				EXPECT_LE(t.pauliString().weight(), depth);
+			}
+		}
+
+		if (n > 14) {
+			continue;
+		}
+		PauliOperator number;
+		for (int i = 0; i < n; i++) {
+			for (int j = 0; j < n; j++) {
+				auto& ai = annihilation[i];
+				auto& aj = annihilation[j];
+				auto& ajDag = creation[j];
+				// isClose also compares the coefficients
+				auto anticommutator = ai * ajDag + ajDag * ai;
+				auto delta = i == j ? PauliOperator(1.0) : PauliOperator();
+				EXPECT_TRUE(anticommutator.isClose(delta));
+				auto vanishing = ai * aj + aj * ai;
+				PauliOperator zero;
+				EXPECT_TRUE(vanishing.isClose(zero));
+			}
+			number += creation[i] * annihilation[i];
+		}
+
+		// |0...0> is the vacuum
+		std::vector<BasisAction> results;
+		number.computeActionOnKet(0, results);
+		std::map<std::uint64_t, std::complex<double>> amplitudes;
+		for (auto& r : results) {
+			amplitudes[r.first] += r.second;
+		}
+		for (auto& a : amplitudes) {
+			EXPECT_NEAR(0.0, std::abs(a.second), 1e-12);
+		}
+	}
+}
+
+TEST(TernaryTreeTransformationTester,checkSpectrum) {
+
+	// A random hermitian one and two body operator has the same
+	// spectrum under the ternary tree and Jordan-Wigner mappings
+	std::mt19937 gen(3);
+	std::uniform_int_distribution<int> site(0, 4), nOps(1, 2);
+	std::uniform_real_distribution<double> coeff(-1.0, 1.0);
+	auto kernel = std::make_shared<FermionKernel>("random");
+	auto& op = kernel->getOperator();
+	for (int i = 0; i < 40; i++) {
+		std::vector<std::pair<int, int>> ops, adjoint;
+		auto n = nOps(gen);
+		for (int k = 0; k < 2 * n; k++) {
+			ops.push_back( { site(gen), k < n });
+		}
+		for (auto it = ops.rbegin(); it != ops.rend(); ++it) {
+			adjoint.push_back( { it->first, !it->second });
+		}
+		std::complex<double> c(coeff(gen), coeff(gen));
+		op.addTerm(ops, c, "");
+		op.addTerm(adjoint, std::conj(c), "");
+	}
+
+	xacc::setOption("n-qubits", "5");
+	TernaryTreeTransformation tt;
+	JordanWignerIRTransformation jw;
+	std::vector<Eigen::VectorXd> spectra;
+	for (auto result : { tt.transform(*kernel), jw.transform(*kernel) }) {
+		Eigen::MatrixXcd m = Eigen::MatrixXcd::Zero(32, 32);
+		for (auto& e : result.getSparseMatrixElements(5)) {
+			m(e.row(), e.col()) += e.coeff();
+		}
+		Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> es(m);
+		spectra.push_back(es.eigenvalues());
+	}
+	EXPECT_NEAR(0.0, (spectra[0] - spectra[1]).norm(), 1e-10);
+}
+
+int main(int argc, char** argv) {
+   xacc::Initialize(argc,argv);
+   ::testing::InitGoogleTest(&argc, argv);
+   auto ret = RUN_ALL_TESTS();
+   xacc::Finalize();
+   return ret;
+}
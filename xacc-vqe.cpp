@@ -16,7 +16,8 @@ int main(int argc, char** argv) {
 	auto vqeOptions = std::make_shared<options_description>("XACC-VQE Options");
 	vqeOptions->add_options()
 				("vqe-program,f",value<std::string>(), "(required) The file containing "
-							"XACC Kernels describing the Hamiltonian to simulate.")
+							"XACC Kernels describing the Hamiltonian to simulate. May be "
+							"omitted if --fermion-kernel-file is given.")
 				("vqe-task,t", value<std::string>(), "(required) The XACC-VQE Task to run.")
 				("vqe-list-tasks,l","List available VQE Tasks.")
 				("vqe-ansatz,a", value<std::string>(),"Provide the file name of the ansatz circuit.")
@@ -25,6 +26,8 @@ int main(int argc, char** argv) {
 				("vqe-parameters,p",  value<std::string>(),"The initial parameters to seed VQE with, pass as string of comma separated parameters.")
 				("vqe-energy-delta,d", value<std::string>(), "The change in energy to consider during classsical optimization.")
 				("correct-readout-errors", "Correct qubit readout errors.")
+				("vqe-pauli-threads", value<std::string>(), "The number of threads used for large "
+						"PauliOperator products and sums, defaults to the number of hardware threads.")
 				("qubit-map", "Provide a list of qubit indices as a comma-separated "
 						"string to use in this computation. The 0th integer corresponds "
 						"to the 0th logical qubit, etc.");
@@ -59,6 +62,9 @@ int main(int argc, char** argv) {
 	}
 
 	xacc::info("Number of Ranks = " + std::to_string(world->size()));
+	if (xacc::optionExists("vqe-pauli-threads")) {
+		PauliOperator::setNumThreads(std::stoi(xacc::getOption("vqe-pauli-threads")));
+	}
 	if (!xacc::optionExists("accelerator")) {
 		xacc::setAccelerator("vqe-dummy");
 		// Set the default Accelerator to TNQVM
@@ -78,7 +84,8 @@ int main(int argc, char** argv) {
 	}
 
 	// Users must specify a file containing VQE Hamiltonian kernels
-	if (!xacc::optionExists("vqe-program")) {
+	if (!xacc::optionExists("vqe-program")
+			&& !xacc::optionExists("fermion-kernel-file")) {
 		xacc::error("You must at least specify a kernel file to run this app.");
 	}
 
@@ -95,10 +102,16 @@ int main(int argc, char** argv) {
 	// Get the task to run
 	auto task = xacc::getOption("vqe-task");
 
-	// Read in the Hamiltonian kernel file
-	std::ifstream moleculeKernelHpp(xacc::getOption("vqe-program"));
-	std::string src((std::istreambuf_iterator<char>(moleculeKernelHpp)),
-			std::istreambuf_iterator<char>());
+	// Read in the Hamiltonian kernel file, unless the
+	// FermionCompiler is to stream the terms from disk itself
+	std::string src;
+	if (xacc::optionExists("vqe-program")) {
+		std::ifstream moleculeKernelHpp(xacc::getOption("vqe-program"));
+		src = std::string((std::istreambuf_iterator<char>(moleculeKernelHpp)),
+				std::istreambuf_iterator<char>());
+	} else {
+		src = "__qpu__ H() {\n}";
+	}
 
 	if (xacc::optionExists("vqe-ansatz")) {
 		std::ifstream spKernelHpp(xacc::getOption("vqe-ansatz"));